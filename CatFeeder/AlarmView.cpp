@@ -24,6 +24,7 @@
 #include "Display.h"
 #include "Data.h"
 #include "Hardware.h"
+#include "Trace.h"
 
 
 using namespace lr;
@@ -37,6 +38,7 @@ void AlarmView::enter()
 
 void AlarmView::loop()
 {
+    LR_TRACE_SCOPE("AlarmView::loop");
     Hardware::dropFood();
     Display::updateAlarm();
     delay(2000);
@@ -31,12 +31,12 @@
 #include "KeyPad.h"
 #include "KeyTestView.h"
 #include "LRPCF8523.h"
+#include "LRTwi.h"
 #include "MenuView.h"
 #include "SetAlarmView.h"
 #include "SetTimeView.h"
 #include "StatusView.h"
-
-#include <Wire.h>
+#include "Trace.h"
 
 
 namespace Application {
@@ -107,10 +107,19 @@ void setupProgrammingMode()
     delay(2000);
 
     // Check the clock configuration.
-    if (Clock::isCorrect()) {
+    const uint8_t failedChecks = Clock::check();
+    if (failedChecks == 0) {
+        // Start the software clock, which is used by all views. On an
+        // unconfigured chip, the interrupt pin still carries the clock
+        // output, so the fix hardware view starts it after the reset.
+        Clock::begin();
         // Switch to the initial state.
         switchToState(cInitialState);
     } else {
+        LR_DEBUG_PRINT(F("Failed RTC checks: 0x"));
+#ifdef LR_DEBUG_ENABLED
+        Serial.println(failedChecks, HEX);
+#endif
         // Display the hardware problem view.
         switchToState(State::FixHw);
     }
@@ -121,7 +130,12 @@ void setupProgrammingMode()
 ///
 void wakeupAndFeed()
 {
+    LR_TRACE_SCOPE("Application::wakeupAndFeed");
     LR_DEBUG_PRINTLN(F("Wakeup to activate feeder."));
+#ifdef LR_HEADLESS_FEEDING_ENABLED
+    // Nobody watches the display at feeding time, just drop the food.
+    Hardware::dropFood();
+#else
     // Initialise components
     Display::begin();
     KeyPad::begin();
@@ -134,40 +148,61 @@ void wakeupAndFeed()
     Display::updateAlarm();
     // Wait and shutdown.
     delay(2000);
+#endif
 }
 
 
 /// Setup everything for a timer event.
 ///
 void setupTimerEvent() {
+    LR_TRACE_SCOPE("Application::setupTimerEvent");
+    // Most wake-ups are regular ones from the timer. A single read of the
+    // control registers decides if there is anything else to do.
+    PCF8523::Snapshot rtc;
+    rtc.read(PCF8523::Register::Control1, PCF8523::Register::Control2);
+    if (!rtc.isAlarm() && !rtc.isInterruptEnabled(PCF8523::Interrupt::Second)) {
+        // This is just one of the regular timed wake-ups.
+        // Shutdown as fast as possible, without any debug output.
+        // This call never returns.
+        Hardware::sendDoneSignal();
+    }
+#if defined(LR_DEBUG_ENABLED) && !defined(LR_TRACE_SERIAL)
+    Serial.begin(115200);
+#endif
     LR_DEBUG_PRINTLN(F("Timer event."));
     // Read the current time from the RTC.
-    Data::now = PCF8523::getDateTime();
+    rtc.read(PCF8523::Register::Seconds, PCF8523::Register::Years);
+    Data::now = rtc.getDateTime();
     LR_DEBUG_PRINT(F("Current date/time: "));
-    LR_DEBUG_PRINTLN(Data::now.toString(DateTime::Format::Long));   
+#ifdef LR_DEBUG_ENABLED
+    Data::now.printTo(Serial, DateTime::Format::Long);
+    Serial.println();
+#endif
+    // The software clock of the programming mode leaves the second interrupt
+    // enabled. Disable it, otherwise the pulses wake the device every second.
+    if (rtc.isInterruptEnabled(PCF8523::Interrupt::Second)) {
+        rtc.disableInterrupt(PCF8523::Interrupt::Second);
+    }
     // Check if the device was woken by an alarm.
-    if (PCF8523::isAlarm()) {
+    if (rtc.isAlarm()) {
         // First, clear the alarm.
-        PCF8523::clearAlarm();
+        rtc.clearAlarm();
         LR_DEBUG_PRINTLN(F("Alarm flag was set."));
         // Read the current alarm time from the RTC.
-        Data::alarmHour = PCF8523::getAlarmHour();
-        Data::alarmMinute = PCF8523::getAlarmMinute();
+        rtc.read(PCF8523::Register::MinuteAlarm, PCF8523::Register::HourAlarm);
+        Data::alarmHour = rtc.getAlarmHour();
+        Data::alarmMinute = rtc.getAlarmMinute();
         LR_DEBUG_PRINT(F("Alarm is set to: "));
         LR_DEBUG_PRINT(Data::alarmHour);
         LR_DEBUG_PRINT(':');
         LR_DEBUG_PRINTLN(Data::alarmMinute);
         // Check if the time matches (or if this was some old unanswered alarm).
-        if (Data::now.getHour() == Data::alarmHour && Data::now.getMinute() == Data::alarmMinute) {
+        if (rtc.isAlarmTime()) {
             // Wakeup fully to activate the feeder.
             wakeupAndFeed();
         } else {
             LR_DEBUG_PRINTLN(F("Alarm does not match current time."));
         }
-    } else {
-        LR_DEBUG_PRINTLN(F("Regular wakeup."));
-        // This is just one of the regular timed wake-ups.
-        // Shutdown as fast as possible.
     }
     // Shutdown the power of the device.
     // This call never returns.
@@ -177,16 +212,21 @@ void setupTimerEvent() {
 
 void setup()
 {
-#ifdef LR_DEBUG_ENABLED
+#ifdef LR_TRACE_SERIAL
+    // The trace markers write to the serial port, start it before the first one.
     Serial.begin(115200);
 #endif
     // Initialise the hardware.
     Hardware::begin();
-    Wire.begin();
+    Twi::begin();
     // Initialise the RTC library.
     PCF8523::begin(2000); // Use year 2000 as base for the time.
+    PCF8523::enableShadow(); // Configuration changes without reading the registers.
     // Check the mode
     if (Hardware::isProgrammingMode()) {
+#if defined(LR_DEBUG_ENABLED) && !defined(LR_TRACE_SERIAL)
+        Serial.begin(115200);
+#endif
         setupProgrammingMode();
         _isProgrammingMode = true;
     } else {
@@ -211,8 +251,12 @@ void loopFullPower()
         }
         _idleCounter = 0;
     }
+    // Keep the software clock in sync with the RTC.
+    Clock::loop();
     // Execute the loop block of the current view.
     _currentView->loop();
+    // Check the bus for a stuck transaction.
+    Twi::poll();
     // Count while the application is idle.
     if (!_isPowerSaveActive) {
         ++_idleCounter;
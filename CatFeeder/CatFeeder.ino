@@ -40,6 +40,8 @@
 // - Pin 3: Connected to Switch, connects to GND if in programming mode.
 // - Pin 4: Output for the done signal. Connected to the TPL5110
 // - Pin 5: Input if the battery is low.
+// - Pin 7: Input from the RTC interrupt, after the BSS84. High while INT1 is active,
+//   pulled low on the custom board otherwise. INT1 is pulled up at the BSS84 gate.
 // - Pin 9: Servo control output. 
 //
 
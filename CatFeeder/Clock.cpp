@@ -21,6 +21,7 @@
 
 
 #include "Configuration.h"
+#include "Hardware.h"
 #include "LRPCF8523.h"
 
 #include <avr/pgmspace.h>
@@ -32,20 +33,75 @@ using namespace lr;
 namespace Clock {
 
 
+/// The expected register values.
+///
+/// The second interrupt and its pulse mode are ignored, they are used by
+/// the software clock.
+///
 static const uint8_t cCheckTable[] PROGMEM {
     // Register to check                                       Expected    Mask
-    static_cast<uint8_t>(PCF8523::Register::Control1),         0b00000010, 0b10101111,
+    static_cast<uint8_t>(PCF8523::Register::Control1),         0b00000010, 0b10101011,
     static_cast<uint8_t>(PCF8523::Register::Control2),         0b00000000, 0b00000111,
     static_cast<uint8_t>(PCF8523::Register::Control3),         0b00100000, 0b11100011,
     static_cast<uint8_t>(PCF8523::Register::Offset),           0b00000000, 0b11111111,
-    static_cast<uint8_t>(PCF8523::Register::TimerAndClockOut), 0b00111000, 0b11111111,
+    static_cast<uint8_t>(PCF8523::Register::TimerAndClockOut), 0b00111000, 0b01111111,
     0xff // End flag.
 };
 
+/// The number of registers read for the check, from Control1 to TimerAndClockOut.
+///
+static const uint8_t cCheckRegisterCount = 0x10;
 
-bool isCorrect()
+/// The enable bits in the alarm registers, which are 0 if the alarm is enabled.
+///
+static const uint8_t cAlarmEnableMask = 0b10000000;
+
+/// The number of seconds between two synchronizations of the software clock.
+///
+static const uint16_t cSynchronizeInterval = 3600;
+
+/// The maximum number of attempts to read the time between two pulses.
+///
+static const uint8_t cSynchronizeAttempts = 3;
+
+/// The time without a pulse after which the software clock is synchronized, in milliseconds.
+///
+/// The pulses come every second. If they stop, for example because the
+/// second interrupt of the RTC was disabled, the clock reads the RTC instead.
+///
+static const uint16_t cPulseTimeoutMillis = 2000;
+
+/// If the software clock was started with begin().
+///
+static bool gIsStarted = false;
+
+/// The time of the RTC at the last synchronization.
+///
+static uint32_t gBaseSeconds = 0;
+
+/// The pulse count at the last synchronization.
+///
+static uint16_t gBasePulseCount = 0;
+
+/// The pulse count at the last call of loop().
+///
+static uint16_t gLastPulseCount = 0;
+
+/// The time of the last pulse or synchronization, from millis().
+///
+static uint32_t gLastPulseMillis = 0;
+
+
+uint8_t check()
 {
+    // Read all registers in one transaction. If the read fails, the
+    // registers stay zero and the checks fail.
+    uint8_t registers[cCheckRegisterCount] = {};
+    PCF8523::readRegister(PCF8523::Register::Control1, registers, cCheckRegisterCount);
+
     // check all registers as defined in the table.
+    uint8_t result = 0;
+    uint8_t checkBit = static_cast<uint8_t>(Check::Control1);
     const uint8_t *entry = cCheckTable;
     while (true) {
         const uint8_t registerValue = pgm_read_byte(entry++);
@@ -54,8 +110,9 @@ bool isCorrect()
         }
         const uint8_t expected = pgm_read_byte(entry++);
         const uint8_t mask = pgm_read_byte(entry++);
-        const uint8_t value = PCF8523::readRegister(static_cast<PCF8523::Register>(registerValue));
+        const uint8_t value = registers[registerValue];
         if ((value & mask) != expected) {
+            result |= checkBit;
 #ifdef LR_DEBUG_ENABLED
             Serial.println(F("RTC Register Check Failed:"));
             Serial.print(F("Register: 0x"));
@@ -67,21 +124,32 @@ bool isCorrect()
             Serial.print(F("Current Value: 0x"));
             Serial.println(value, HEX);
 #endif
-            return false;
         }
+        checkBit <<= 1;
     }
     
-    // Check if the alarm mode is set correctly.
-    if (PCF8523::getAlarmMode() != PCF8523::AlarmMode::HourMinute) {
+    // Check if the alarm mode is set correctly: only hour and minute are enabled.
+    const uint8_t minuteAlarm = registers[static_cast<uint8_t>(PCF8523::Register::MinuteAlarm)];
+    const uint8_t hourAlarm = registers[static_cast<uint8_t>(PCF8523::Register::HourAlarm)];
+    const uint8_t dayAlarm = registers[static_cast<uint8_t>(PCF8523::Register::DayAlarm)];
+    const uint8_t weekdayAlarm = registers[static_cast<uint8_t>(PCF8523::Register::WeekdayAlarm)];
+    if ((minuteAlarm & cAlarmEnableMask) != 0 || (hourAlarm & cAlarmEnableMask) != 0
+        || (dayAlarm & cAlarmEnableMask) == 0 || (weekdayAlarm & cAlarmEnableMask) == 0) {
+        result |= static_cast<uint8_t>(Check::AlarmMode);
 #ifdef LR_DEBUG_ENABLED
         Serial.println(F("RTC Alarm Mode Check Failed:"));
-        Serial.print(F("Current mode: 0x"));
-        Serial.println(static_cast<int>(PCF8523::getAlarmMode()), HEX);
+        Serial.print(F("Alarm registers: 0x"));
+        Serial.print(minuteAlarm, HEX);
+        Serial.print(F(" 0x"));
+        Serial.print(hourAlarm, HEX);
+        Serial.print(F(" 0x"));
+        Serial.print(dayAlarm, HEX);
+        Serial.print(F(" 0x"));
+        Serial.println(weekdayAlarm, HEX);
 #endif
-        return false;
     }
 
-    return true;
+    return result;
 }
 
 
@@ -90,20 +158,89 @@ void reset()
     // First do a software reset.
     // After this, most of the values are already correct.
     PCF8523::reset();
-    // Fix the remaining ones.
-    PCF8523::setPowerManagement(PCF8523::PowerManagement::DirectSwitchAndLowBatDetect);
-    PCF8523::setClockOutFrequency(PCF8523::ClockFrequency::Disabled);
+    // Collect the remaining changes and write them in one go.
+    PCF8523::StagedWrite changes;
+    changes.setPowerManagement(PCF8523::PowerManagement::DirectSwitchAndLowBatDetect);
+    changes.setClockOutFrequency(PCF8523::ClockFrequency::Disabled);
     // Make sure the alarm interrupt is enabled.
-    PCF8523::enableInterrupt(PCF8523::Interrupt::Alarm);
-    PCF8523::clearInterruptFlag(PCF8523::Interrupt::Alarm);
+    changes.enableInterrupt(PCF8523::Interrupt::Alarm);
+    changes.clearInterruptFlag(PCF8523::Interrupt::Alarm);
     // Set the alarm mode.
-    PCF8523::setAlarmMode(PCF8523::AlarmMode::HourMinute);
+    changes.setAlarmMode(PCF8523::AlarmMode::HourMinute);
     // Now reset the clock and alarm.
-    PCF8523::setDateTime(DateTime(2017, 1, 1, 12, 0, 0));
-    PCF8523::setAlarmMinute(0);
-    PCF8523::setAlarmHour(0);
-    PCF8523::setAlarmDay(1); // Not used.
-    PCF8523::setAlarmDayOfWeek(0); // Not used.
+    changes.setDateTime(DateTime(2017, 1, 1, 12, 0, 0));
+    changes.setAlarmMinute(0);
+    changes.setAlarmHour(0);
+    changes.setAlarmDay(1); // Not used.
+    changes.setAlarmDayOfWeek(0); // Not used.
+    changes.flush();
+}
+
+
+void begin()
+{
+    PCF8523::StagedWrite changes;
+    changes.enableInterrupt(PCF8523::Interrupt::Second);
+    changes.setField<PCF8523::TimerAInterruptModeField>(1); // Pulses of 1/64s.
+    changes.flush();
+    Hardware::enableRtcInterruptInput();
+    synchronize();
+    gIsStarted = true;
+}
+
+
+void synchronize()
+{
+    // The seconds of the RTC advance with each pulse, so a pulse during
+    // the read would shift the time against the counter by one.
+    for (uint8_t attempt = 0; attempt < cSynchronizeAttempts; ++attempt) {
+        const uint16_t pulseCount = Hardware::getRtcPulseCount();
+        const uint32_t seconds = PCF8523::getDateTime().toSecondsSince2000();
+        gBaseSeconds = seconds;
+        gBasePulseCount = pulseCount;
+        if (pulseCount == Hardware::getRtcPulseCount()) {
+            break;
+        }
+    }
+    gLastPulseCount = gBasePulseCount;
+    gLastPulseMillis = millis();
+}
+
+
+void loop()
+{
+    if (!gIsStarted) {
+        return;
+    }
+    const uint16_t pulseCount = Hardware::getRtcPulseCount();
+    const uint32_t currentMillis = millis();
+    if (pulseCount != gLastPulseCount) {
+        gLastPulseCount = pulseCount;
+        gLastPulseMillis = currentMillis;
+    }
+    if (static_cast<uint16_t>(pulseCount - gBasePulseCount) >= cSynchronizeInterval
+        || currentMillis - gLastPulseMillis > cPulseTimeoutMillis) {
+        synchronize();
+    }
+}
+
+
+uint32_t getSecondsSince2000()
+{
+    return gBaseSeconds + static_cast<uint16_t>(Hardware::getRtcPulseCount() - gBasePulseCount);
+}
+
+
+DateTime getDateTime()
+{
+    return DateTime::fromSecondsSince2000(getSecondsSince2000());
+}
+
+
+void setDateTime(const DateTime &dateTime)
+{
+    PCF8523::setDateTime(dateTime);
+    synchronize();
 }
 
 
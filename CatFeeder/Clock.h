@@ -20,23 +20,90 @@
 //
 
 
+#include "LRDateTime.h"
+
+#include <Arduino.h>
+
+
 /// Simple component to check and fix the RTC configuration.
 ///
+/// In programming mode, the component also keeps a software clock. It
+/// counts the pulses of the RTC second interrupt, so reading the time
+/// needs no I2C access. The clock is synchronized with the RTC once per
+/// hour, and if no pulse arrived for two seconds.
+///
 namespace Clock {
 
 
+/// The checks of the RTC configuration.
+///
+/// Each check is one bit in the result of check().
+///
+enum class Check : uint8_t {
+    Control1 = (1<<0), ///< The control register 1.
+    Control2 = (1<<1), ///< The control register 2.
+    Control3 = (1<<2), ///< The control register 3.
+    Offset = (1<<3), ///< The offset register.
+    TimerAndClockOut = (1<<4), ///< The timer and clock out register.
+    AlarmMode = (1<<5), ///< The alarm mode in the alarm registers.
+};
+
+
+/// This checks the current configuration of the RTC.
+///
+/// All registers are read in one transaction and all checks are done.
+///
+/// @return The bits of all failed checks, zero if everything is ok.
+///
+uint8_t check();
+
 /// This checks the current configuration of the RTC.
 ///
 /// @return `true` if everything is ok, `false` if the configuration isn't correct.
 ///
-bool isCorrect();
+inline bool isCorrect() { return check() == 0; }
 
 /// Fix the RTC configuration.
 ///
-/// This does also reset the time and date.
+/// This does also reset the time and date, and stops the second interrupt.
 ///
 void reset();
 
+/// Start the software clock.
+///
+/// This enables the pulsed second interrupt of the RTC, starts counting
+/// the pulses and synchronizes the clock. Only use this in programming
+/// mode, in normal mode the pulses on INT1 would wake the device.
+///
+void begin();
+
+/// Synchronize the software clock with the time of the RTC.
+///
+/// Call this after the alarm flag was cleared, because the active alarm
+/// interrupt hides the second pulses.
+///
+void synchronize();
+
+/// Synchronize the software clock if necessary.
+///
+/// Call this from the main loop.
+///
+void loop();
+
+/// Get the current time from the software clock.
+///
+/// @return The time in seconds since 2000-01-01 00:00:00.
+///
+uint32_t getSecondsSince2000();
+
+/// Get the current date/time from the software clock.
+///
+lr::DateTime getDateTime();
+
+/// Set the date/time of the RTC and the software clock.
+///
+void setDateTime(const lr::DateTime &dateTime);
+
 
 }
 
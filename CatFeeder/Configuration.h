@@ -26,6 +26,19 @@
 // Enable serial output for debugging.
 #define LR_DEBUG_ENABLED 1
 
+// Enable the trace markers from `Trace.h`.
+// On the device, the markers are written to the serial port, which
+// needs the debug output above. The serial port is then started at boot,
+// also for the regular timer wake-ups, which makes them slower.
+// The host build enables them unless CATFEEDER_TRACE is off, and records
+// them without the serial port.
+//#define LR_TRACE_ENABLED 1
+
+// Feed without the display on alarm wake-ups.
+// The LCD and the keypad are not initialized, and the device powers off
+// right after the servo motion. Disable it to show the feeding screens.
+#define LR_HEADLESS_FEEDING_ENABLED 1
+
 
 
 
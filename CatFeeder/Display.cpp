@@ -21,10 +21,8 @@
 
 
 #include "Data.h"
-
-#include <Wire.h>
-#include <Adafruit_MCP23017.h>
-#include <Adafruit_RGBLCDShield.h>
+#include "LRRgbLcdShield.h"
+#include "Trace.h"
 
 #include <avr/pgmspace.h>
 
@@ -36,6 +34,10 @@ using namespace lr;
 
 
 // Custom characters for the LCD display.
+//
+// The character codes 0x01-0x08 are glyphs. The frame buffer keeps these
+// codes, and the glyph cache loads them into the character memory of the
+// LCD when they are shown for the first time.
 const uint8_t cClockCharacterMask[] PROGMEM = {
   0b01110,
   0b11011,
@@ -125,6 +127,27 @@ const uint8_t cArrowUpCharacterMask[] PROGMEM = {
 };
 const char cArrowUpCharacter = '\x08';
 
+/// The masks of all glyphs, for the codes starting with `cFirstGlyph`.
+///
+const uint8_t *const cGlyphMasks[] = {
+    cClockCharacterMask,
+    cFeedCharacterMask,
+    cArrowLeftCharacterMask,
+    cArrowRightCharacterMask,
+    cDiagTRCharacterMask,
+    cDiagTLCharacterMask,
+    cBatteryCharacterMask,
+    cArrowUpCharacterMask,
+};
+
+/// The code of the first glyph.
+///
+const uint8_t cFirstGlyph = 0x01;
+
+/// The number of glyphs.
+///
+const uint8_t cGlyphCount = sizeof(cGlyphMasks) / sizeof(cGlyphMasks[0]);
+
 /// The menu texts.
 ///
 const char cMenu1Text[] PROGMEM = "Adjust Alarm";
@@ -133,13 +156,318 @@ const char cMenu3Text[] PROGMEM = "Test Feeder";
 const char cMenu4Text[] PROGMEM = "Test Buttons";
 PGM_P cMenuText[] = {cMenu1Text, cMenu2Text, cMenu3Text, cMenu4Text};
 
+/// The number of columns of the LCD.
+///
+const uint8_t cColumnCount = 16;
+
+/// The number of rows of the LCD.
+///
+const uint8_t cRowCount = 2;
+
+
+/// A cache for the glyphs in the character memory of the LCD.
+///
+/// The LCD has eight slots for custom characters. A glyph is loaded into
+/// a slot when a frame shows it, preferably into the slot which matches its
+/// code, so the common glyphs keep their place. If all slots are in use,
+/// the least recently shown glyph which is not part of the frame is
+/// replaced. One frame can show up to eight different glyphs.
+///
+class GlyphCache
+{
+public:
+    /// Create an empty cache.
+    ///
+    GlyphCache();
+
+public:
+    /// Forget all loaded glyphs, after the LCD was initialized.
+    ///
+    void reset();
+
+    /// Load all glyphs of a frame into the character memory.
+    ///
+    /// @param glyphMask The glyphs of the frame, bit 0 for `cFirstGlyph`.
+    /// @return `true` if a glyph was written, which moves the cursor of
+    ///    the LCD to the home position.
+    ///
+    bool load(uint16_t glyphMask);
+
+    /// Get the character code for a loaded glyph.
+    ///
+    uint8_t getCharacter(uint8_t glyph) const;
+
+    /// Check if a character code is a glyph.
+    ///
+    static bool isGlyph(uint8_t value);
+
+private:
+    /// The number of slots in the character memory.
+    ///
+    static const uint8_t cSlotCount = 8;
+
+    /// The value for a glyph without slot, or a slot without glyph.
+    ///
+    static const uint8_t cNone = 0xff;
+
+private:
+    /// Move a slot to the front of the usage order.
+    ///
+    void markUsed(uint8_t slot);
+
+private:
+    uint8_t _glyphSlots[cGlyphCount]; ///< The slot of each glyph.
+    uint8_t _slotGlyphs[cSlotCount]; ///< The glyph in each slot.
+    uint8_t _slotOrder[cSlotCount]; ///< The slots, the most recently used first.
+};
+
+
+/// A frame buffer with the characters of the LCD.
+///
+/// The views draw into the frame buffer, which keeps a second copy with
+/// the characters shown on the LCD. `flush()` compares both and only sends
+/// the changed cells, with a cursor move only where the next changed cell
+/// does not follow the last written one. Glyphs are loaded into the
+/// character memory before the cells are sent.
+///
+class FrameBuffer : public Print
+{
+public:
+    /// Create a frame buffer for an empty LCD.
+    ///
+    FrameBuffer();
+
+public:
+    /// Mark the LCD as empty, after it was initialized.
+    ///
+    /// This also forgets the cursor position of the LCD.
+    ///
+    void reset();
+
+    /// Fill the frame buffer with spaces and move the cursor home.
+    ///
+    void clear();
+
+    /// Move the cursor in the frame buffer.
+    ///
+    void setCursor(uint8_t column, uint8_t row);
+
+    /// Send all changed cells to the LCD.
+    ///
+    /// @param placeCursor If the cursor of the LCD is moved to the cursor
+    ///    of the frame buffer, for a visible cursor.
+    ///
+    void flush(bool placeCursor);
+
+    /// Write a character into the frame buffer.
+    ///
+    /// Characters right of the last column are ignored.
+    ///
+    size_t write(uint8_t value) override;
+    using Print::write;
+
+private:
+    /// The value for an unknown cursor position of the LCD.
+    ///
+    static const uint8_t cUnknownPosition = 0xff;
+
+private:
+    char _cells[cRowCount][cColumnCount]; ///< The characters to show.
+    char _shownCells[cRowCount][cColumnCount]; ///< The characters on the LCD.
+    uint8_t _column; ///< The cursor column in the frame buffer.
+    uint8_t _row; ///< The cursor row in the frame buffer.
+    uint8_t _lcdColumn; ///< The cursor column of the LCD.
+    uint8_t _lcdRow; ///< The cursor row of the LCD.
+};
+
+
 /// The global instance for the LCD display.
-static Adafruit_RGBLCDShield _lcd = Adafruit_RGBLCDShield();
+static RgbLcdShield _lcd;
+
+/// The glyphs in the character memory of the LCD.
+///
+static GlyphCache _glyphs;
+
+/// The frame buffer for the LCD.
+///
+static FrameBuffer _screen;
 
 /// The current displayed view.
 ///
 static View _currentView = View::Off;
 
+/// Flag if the cursor of the LCD blinks.
+///
+static bool _isCursorBlinking = false;
+
+
+GlyphCache::GlyphCache()
+{
+    reset();
+}
+
+
+void GlyphCache::reset()
+{
+    memset(_glyphSlots, cNone, sizeof(_glyphSlots));
+    memset(_slotGlyphs, cNone, sizeof(_slotGlyphs));
+    for (uint8_t i = 0; i < cSlotCount; ++i) {
+        _slotOrder[i] = i;
+    }
+}
+
+
+bool GlyphCache::load(uint16_t glyphMask)
+{
+    LR_TRACE_SCOPE("Display::GlyphCache::load");
+    // Mark the loaded glyphs first, so none of them is replaced.
+    for (uint8_t glyph = 0; glyph < cGlyphCount; ++glyph) {
+        if ((glyphMask & (1u << glyph)) != 0 && _glyphSlots[glyph] != cNone) {
+            markUsed(_glyphSlots[glyph]);
+        }
+    }
+    bool hasWrites = false;
+    for (uint8_t glyph = 0; glyph < cGlyphCount; ++glyph) {
+        if ((glyphMask & (1u << glyph)) == 0 || _glyphSlots[glyph] != cNone) {
+            continue;
+        }
+        uint8_t slot = (cFirstGlyph + glyph) % cSlotCount;
+        if (_slotGlyphs[slot] != cNone) {
+            slot = _slotOrder[cSlotCount - 1];
+        }
+        if (_slotGlyphs[slot] != cNone) {
+            _glyphSlots[_slotGlyphs[slot]] = cNone;
+        }
+        uint8_t character[8];
+        memcpy_P(character, cGlyphMasks[glyph], 8);
+        _lcd.createChar(slot, character);
+        _slotGlyphs[slot] = glyph;
+        _glyphSlots[glyph] = slot;
+        markUsed(slot);
+        hasWrites = true;
+    }
+    return hasWrites;
+}
+
+
+uint8_t GlyphCache::getCharacter(uint8_t glyph) const
+{
+    return _glyphSlots[glyph - cFirstGlyph];
+}
+
+
+bool GlyphCache::isGlyph(uint8_t value)
+{
+    return value >= cFirstGlyph && value < cFirstGlyph + cGlyphCount;
+}
+
+
+void GlyphCache::markUsed(uint8_t slot)
+{
+    uint8_t i = 0;
+    while (_slotOrder[i] != slot) {
+        ++i;
+    }
+    for (; i > 0; --i) {
+        _slotOrder[i] = _slotOrder[i - 1];
+    }
+    _slotOrder[0] = slot;
+}
+
+
+FrameBuffer::FrameBuffer()
+    : _column(0), _row(0), _lcdColumn(cUnknownPosition), _lcdRow(cUnknownPosition)
+{
+    reset();
+    clear();
+}
+
+
+void FrameBuffer::reset()
+{
+    memset(_shownCells, ' ', sizeof(_shownCells));
+    _lcdColumn = cUnknownPosition;
+    _lcdRow = cUnknownPosition;
+}
+
+
+void FrameBuffer::clear()
+{
+    memset(_cells, ' ', sizeof(_cells));
+    _column = 0;
+    _row = 0;
+}
+
+
+void FrameBuffer::setCursor(uint8_t column, uint8_t row)
+{
+    _column = column;
+    _row = row;
+}
+
+
+void FrameBuffer::flush(bool placeCursor)
+{
+    LR_TRACE_SCOPE("Display::FrameBuffer::flush");
+    uint16_t glyphMask = 0;
+    for (uint8_t row = 0; row < cRowCount; ++row) {
+        for (uint8_t column = 0; column < cColumnCount; ++column) {
+            const uint8_t value = static_cast<uint8_t>(_cells[row][column]);
+            if (GlyphCache::isGlyph(value)) {
+                glyphMask |= (1u << (value - cFirstGlyph));
+            }
+        }
+    }
+    if (_glyphs.load(glyphMask)) {
+        _lcdColumn = 0;
+        _lcdRow = 0;
+    }
+    for (uint8_t row = 0; row < cRowCount; ++row) {
+        for (uint8_t column = 0; column < cColumnCount; ++column) {
+            const char value = _cells[row][column];
+            if (value == _shownCells[row][column]) {
+                continue;
+            }
+            if (column != _lcdColumn || row != _lcdRow) {
+                _lcd.setCursor(column, row);
+                _lcdRow = row;
+            }
+            if (GlyphCache::isGlyph(static_cast<uint8_t>(value))) {
+                _lcd.write(_glyphs.getCharacter(static_cast<uint8_t>(value)));
+            } else {
+                _lcd.write(static_cast<uint8_t>(value));
+            }
+            _shownCells[row][column] = value;
+            // The LCD moves its cursor to the next column.
+            _lcdColumn = column + 1;
+        }
+    }
+    if (placeCursor && (_column != _lcdColumn || _row != _lcdRow)) {
+        _lcd.setCursor(_column, _row);
+        _lcdColumn = _column;
+        _lcdRow = _row;
+    }
+}
+
+
+size_t FrameBuffer::write(uint8_t value)
+{
+    if (_row >= cRowCount || _column >= cColumnCount) {
+        return 0;
+    }
+    _cells[_row][_column] = static_cast<char>(value);
+    ++_column;
+    return 1;
+}
+
+
+/// Send the changes of the frame buffer to the LCD.
+///
+void flushScreen()
+{
+    _screen.flush(_isCursorBlinking);
+}
+
 
 /// Print a decimal number padded with an optional zero to the LCD.
 ///
@@ -147,34 +475,19 @@ static View _currentView = View::Off;
 ///
 void lcdPrintPaddedDecimal(uint8_t value) {
   if (value < 10) {
-    _lcd.print('0');
+    _screen.print('0');
   }
-  _lcd.print(value, DEC);
+  _screen.print(value, DEC);
 }
 
 
 void begin()
 {
     // Setup the LCD display.
-    _lcd.begin(16, 2);
-    // Add custom characters from the masks.
-    uint8_t character[8];
-    memcpy_P(character, cClockCharacterMask, 8);
-    _lcd.createChar(cClockCharacter, character);
-    memcpy_P(character, cFeedCharacterMask, 8);
-    _lcd.createChar(cFeedCharacter, character);
-    memcpy_P(character, cArrowLeftCharacterMask, 8);
-    _lcd.createChar(cArrowLeftCharacter, character);
-    memcpy_P(character, cArrowRightCharacterMask, 8);
-    _lcd.createChar(cArrowRightCharacter, character);
-    memcpy_P(character, cDiagTRCharacterMask, 8);
-    _lcd.createChar(cDiagTRCharacter, character);
-    memcpy_P(character, cDiagTLCharacterMask, 8);
-    _lcd.createChar(cDiagTLCharacter, character);
-    memcpy_P(character, cBatteryCharacterMask, 8);
-    _lcd.createChar(cBatteryCharacter, character);
-    memcpy_P(character, cArrowUpCharacterMask, 8);
-    _lcd.createChar(cArrowUpCharacter, character);
+    _lcd.begin(cColumnCount, cRowCount);
+    // The LCD is empty, and the character memory is undefined.
+    _glyphs.reset();
+    _screen.reset();
 }
 
 
@@ -191,9 +504,9 @@ void setPowerSave(bool enabled)
 void initializeWelcome()
 {
     _lcd.setBacklight(0b101); // Violet
-    _lcd.print(F("   Cat Feeder"));
-    _lcd.setCursor(0, 1);
-    _lcd.print(F("    Welcome!"));
+    _screen.print(F("   Cat Feeder"));
+    _screen.setCursor(0, 1);
+    _screen.print(F("    Welcome!"));
 }
 
 
@@ -205,29 +518,30 @@ void initializeStatus()
 
 void menuDrawScreen(uint8_t menuIndex)
 {
-    _lcd.setCursor(0, 0);
-    _lcd.print(F("      MENU      "));
-    _lcd.setCursor(0, 1);
-    _lcd.print(cArrowRightCharacter);
-    _lcd.print(' ');
+    _screen.setCursor(0, 0);
+    _screen.print(F("      MENU      "));
+    _screen.setCursor(0, 1);
+    _screen.print(cArrowRightCharacter);
+    _screen.print(' ');
     const char *menuText = cMenuText[menuIndex];
     for (uint8_t i = 0; i < 12; ++i) {
         const char menuChar = pgm_read_byte(menuText); 
         if (menuChar != '\0') {
-            _lcd.print(menuChar);
+            _screen.print(menuChar);
             ++menuText;
         } else {
-            _lcd.print(' ');
+            _screen.print(' ');
         }
     }
-    _lcd.print(' ');
-    _lcd.print(cArrowLeftCharacter);
+    _screen.print(' ');
+    _screen.print(cArrowLeftCharacter);
 }
 
 
 void updateMenu(uint8_t menuIndex)
 {
     menuDrawScreen(menuIndex);
+    flushScreen();
 }
 
 
@@ -253,72 +567,82 @@ void initializeSetAlarm()
 void initializeFeederTest()
 {
     _lcd.setBacklight(0b011); // Yellow
-    _lcd.print(F("  Feeder Test   "));
-    _lcd.setCursor(0, 1);
-    _lcd.print(F("\x04 Press Select  "));
+    _screen.print(F("  Feeder Test   "));
+    _screen.setCursor(0, 1);
+    _screen.print(F("\x04 Press Select  "));
 }
 
 
 void updateFeederTest(bool running)
 {
     if (running) {
-        _lcd.setCursor(0, 1);
-        _lcd.print(F("Running...      "));
+        _screen.setCursor(0, 1);
+        _screen.print(F("Running...      "));
     } else {
-        _lcd.setCursor(0, 1);
-        _lcd.print(F("\x04 Press Select  "));
+        _screen.setCursor(0, 1);
+        _screen.print(F("\x04 Press Select  "));
     }
+    flushScreen();
 }
 
 
 void initializeKeyTest()
 {
     _lcd.setBacklight(0b101); // Pink
-    _lcd.print(F("Key Pad Test:"));
-    _lcd.setCursor(0, 1);
+    _screen.print(F("Key Pad Test:"));
+    _screen.setCursor(0, 1);
 }
 
 
 void initializeFixHw()
 {
     _lcd.setBacklight(0b001); // Red!
-    _lcd.print(F("HW Config Issue!"));
-    _lcd.setCursor(0, 1);
-    _lcd.print(F("Select \x04 Reset "));
+    _screen.print(F("HW Config Issue!"));
+    _screen.setCursor(0, 1);
+    _screen.print(F("Select \x04 Reset "));
     _lcd.blink();
+    _isCursorBlinking = true;
 }
 
 
 void updateFixHw()
 {
-    _lcd.setCursor(0, 1);
-    _lcd.print(F("Reset...       "));
+    _screen.setCursor(0, 1);
+    _screen.print(F("Reset...       "));
+    flushScreen();
 }
 
 
 void initializeAlarm()
 {
     _lcd.setBacklight(0b010); // Green
-    _lcd.print(F("\x02 Feeding Time \x02"));
-    _lcd.setCursor(0, 1);
-    _lcd.print(F("      ...       "));
+    _screen.print(F("\x02 Feeding Time \x02"));
+    _screen.setCursor(0, 1);
+    _screen.print(F("      ...       "));
 }
 
 
 void updateAlarm()
 {
-    _lcd.setCursor(0, 1);
-    _lcd.print(F("     done!      "));
+    _screen.setCursor(0, 1);
+    _screen.print(F("     done!      "));
+    flushScreen();
 }
 
 
-void switchToView(View view)
+/// Draw a new view into the frame buffer.
+///
+/// The LCD is not cleared, the next flush overwrites the changed cells.
+///
+void initializeView(View view)
 {
     if (_currentView != view) {
         _currentView = view;
-        _lcd.clear();
-        _lcd.noBlink();
-        _lcd.noCursor();
+        _screen.clear();
+        if (_isCursorBlinking) {
+            _lcd.noBlink();
+            _isCursorBlinking = false;
+        }
         switch(view) {
         case View::Welcome: initializeWelcome(); break;
         case View::Status: initializeStatus(); break;
@@ -335,104 +659,116 @@ void switchToView(View view)
 }
 
 
+void switchToView(View view)
+{
+    LR_TRACE_SCOPE("Display::switchToView");
+    initializeView(view);
+    flushScreen();
+}
+
+
 void updateStatus(bool blinkState)
 {
-    switchToView(View::Status);
+    initializeView(View::Status);
     
     // Date and time.
-    _lcd.setCursor(0, 0);
-    _lcd.print(cClockCharacter);
-    _lcd.print(Data::now.toString(DateTime::Format::ShortTime));
-    _lcd.print(' ');
-    _lcd.print(Data::now.toString(DateTime::Format::ShortDate));
+    _screen.setCursor(0, 0);
+    _screen.print(cClockCharacter);
+    Data::now.printTo(_screen, DateTime::Format::ShortTime);
+    _screen.print(' ');
+    Data::now.printTo(_screen, DateTime::Format::ShortDate);
     lcdPrintPaddedDecimal(Data::now.getYear()%100);
     
     // Alarm.
-    _lcd.setCursor(0, 1);
-    _lcd.print(cFeedCharacter);
+    _screen.setCursor(0, 1);
+    _screen.print(cFeedCharacter);
     lcdPrintPaddedDecimal(Data::alarmHour);
-    _lcd.print(':');
+    _screen.print(':');
     lcdPrintPaddedDecimal(Data::alarmMinute);
 
     // Warnings
-    _lcd.setCursor(14, 1);
+    _screen.setCursor(14, 1);
     if (blinkState) {
         if (Data::warning == Data::Warning::RtcBatteryLow) {
-            _lcd.print(F("\x01\x07"));
+            _screen.print(F("\x01\x07"));
         } else if (Data::warning == Data::Warning::RtcBatteryLow) {
-            _lcd.print(F("\x04\x07"));
+            _screen.print(F("\x04\x07"));
         } else {
-            _lcd.print(F("  "));
+            _screen.print(F("  "));
         }
     } else {
-        _lcd.print(F("  "));
+        _screen.print(F("  "));
     }
+    flushScreen();
 }
 
 
 void updateSetTime(uint8_t adjustIndex, bool blinkState)
 {
-    _lcd.setCursor(0, 0);
-    _lcd.print(cClockCharacter);
+    _screen.setCursor(0, 0);
+    _screen.print(cClockCharacter);
     lcdPrintPaddedDecimal(Data::now.getHour());
-    _lcd.print(':');
+    _screen.print(':');
     lcdPrintPaddedDecimal(Data::now.getMinute());
-    _lcd.print(' ');
+    _screen.print(' ');
     lcdPrintPaddedDecimal(Data::now.getDay());
-    _lcd.print('.');
+    _screen.print('.');
     lcdPrintPaddedDecimal(Data::now.getMonth());
-    _lcd.print('.');
+    _screen.print('.');
     lcdPrintPaddedDecimal(Data::now.getYear() % 100);
-    _lcd.setCursor(0, 1);
+    _screen.setCursor(0, 1);
     if (blinkState) {
         switch (adjustIndex) {
-        case 0: _lcd.print(F(" \x08\x08             ")); break;
-        case 1: _lcd.print(F("    \x08\x08          ")); break;
-        case 2: _lcd.print(F("       \x08\x08       ")); break;
-        case 3: _lcd.print(F("          \x08\x08    ")); break;
-        case 4: _lcd.print(F("             \x08\x08 ")); break;
-        case 5: _lcd.print(F("  OK? \x04 Select  ")); break;
+        case 0: _screen.print(F(" \x08\x08             ")); break;
+        case 1: _screen.print(F("    \x08\x08          ")); break;
+        case 2: _screen.print(F("       \x08\x08       ")); break;
+        case 3: _screen.print(F("          \x08\x08    ")); break;
+        case 4: _screen.print(F("             \x08\x08 ")); break;
+        case 5: _screen.print(F("  OK? \x04 Select  ")); break;
         }
     } else {
-        _lcd.print(F("                "));
+        _screen.print(F("                "));
     }
+    flushScreen();
 }
 
 
 void updateSetAlarm(uint8_t adjustIndex, bool blinkState)
 {
-    _lcd.setCursor(0, 0);
-    _lcd.print(cFeedCharacter);
+    _screen.setCursor(0, 0);
+    _screen.print(cFeedCharacter);
     lcdPrintPaddedDecimal(Data::alarmHour);
-    _lcd.print(':');
+    _screen.print(':');
     lcdPrintPaddedDecimal(Data::alarmMinute);
-    _lcd.setCursor(0, 1);
+    _screen.setCursor(0, 1);
     if (blinkState) {
         switch (adjustIndex) {
-        case 0: _lcd.print(F(" \x08\x08             ")); break;
-        case 1: _lcd.print(F("    \x08\x08          ")); break;
-        case 2: _lcd.print(F("  OK? \x04 Select  ")); break;
+        case 0: _screen.print(F(" \x08\x08             ")); break;
+        case 1: _screen.print(F("    \x08\x08          ")); break;
+        case 2: _screen.print(F("  OK? \x04 Select  ")); break;
         }
     } else {
-        _lcd.print(F("                "));
+        _screen.print(F("                "));
     }
+    flushScreen();
 }
 
 
 void updateKeyTest(char c)
 {
     static uint8_t pos = 0;
-    switchToView(View::KeyTest);
+    initializeView(View::KeyTest);
     if (c != ' ') {
-        _lcd.setCursor(pos, 1);
-        _lcd.print(c);
-        _lcd.print('_');
+        _screen.setCursor(pos, 1);
+        _screen.print(c);
+        _screen.print('_');
         if (++pos >= 16) {
             pos = 0;
-            _lcd.setCursor(pos, 1);
-            _lcd.print('_');
+            _screen.setCursor(pos, 1);
+            _screen.print('_');
         }
     }
+    flushScreen();
 }
 
 
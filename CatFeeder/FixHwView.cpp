@@ -37,6 +37,7 @@ void FixHwView::handleKeyPress(KeyPad::Key key)
 {
     if (key == KeyPad::Select) {
         Clock::reset();
+        Clock::begin();
         Display::updateFixHw();
         delay(2000);
         Application::switchToState(Application::State::Status);
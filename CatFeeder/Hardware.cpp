@@ -20,8 +20,12 @@
 #include "Hardware.h"
 
 
+#include "Trace.h"
+
 #include <Servo.h>
 #include <Arduino.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
 
 
 namespace Hardware {
@@ -49,6 +53,22 @@ const uint8_t cDoneSignalPin = 4;
 ///
 const uint8_t cBatteryLowPin = 5;
 
+/// The pin with the interrupt output of the RTC.
+///
+/// The BSS84 level shifter drives the pin high while INT1 is active.
+/// The open-drain INT1 has its pull-up at the gate of the BSS84, and the
+/// line after the BSS84 is pulled low on the custom board. Therefore the
+/// pin is a plain input, an internal pull-up would hold it high.
+/// The pin is PD7, which is PCINT23 of the pin change interrupt 2.
+///
+const uint8_t cRtcInterruptPin = 7;
+
+/// The time after a rising edge when the RTC interrupt output is held (us).
+///
+/// This is longer than the 1/64 s pulse of the second interrupt.
+///
+const uint32_t cRtcInterruptHoldMicros = 20000;
+
 
 /// Start position of the servo (cup can be filled).
 ///
@@ -70,6 +90,30 @@ const uint16_t cServoSlowMotionDuration = 2500;
 ///
 Servo gServo;
 
+/// The number of rising edges on the RTC interrupt pin.
+///
+volatile uint16_t gRtcPulseCount = 0;
+
+/// The time of the last rising edge on the RTC interrupt pin.
+///
+volatile uint32_t gRtcRiseMicros = 0;
+
+/// Flag if the last rising edge was not checked for a hold.
+///
+/// This is initially set, because the output may be held since power on.
+///
+volatile bool gIsRtcRiseUnchecked = true;
+
+
+ISR(PCINT2_vect)
+{
+    if (digitalRead(cRtcInterruptPin) == HIGH) {
+        ++gRtcPulseCount;
+        gRtcRiseMicros = micros();
+        gIsRtcRiseUnchecked = true;
+    }
+}
+
 
 void begin()
 {
@@ -82,6 +126,7 @@ void begin()
 
 void dropFood()
 {
+    LR_TRACE_SCOPE("Hardware::dropFood");
     // Enable power to the servo.
     pinMode(cServoPowerPin, OUTPUT);
     digitalWrite(cServoPowerPin, LOW);
@@ -115,6 +160,42 @@ void dropFood()
 }
 
 
+void enableRtcInterruptInput()
+{
+    pinMode(cRtcInterruptPin, INPUT);
+    cli();
+    PCMSK2 |= _BV(PCINT23);
+    PCICR |= _BV(PCIE2);
+    sei();
+}
+
+
+uint16_t getRtcPulseCount()
+{
+    cli();
+    const uint16_t result = gRtcPulseCount;
+    sei();
+    return result;
+}
+
+
+bool checkRtcInterruptHeld()
+{
+    bool result = false;
+    cli();
+    if (gIsRtcRiseUnchecked) {
+        if (digitalRead(cRtcInterruptPin) == LOW) {
+            gIsRtcRiseUnchecked = false;
+        } else if (micros() - gRtcRiseMicros >= cRtcInterruptHoldMicros) {
+            gIsRtcRiseUnchecked = false;
+            result = true;
+        }
+    }
+    sei();
+    return result;
+}
+
+
 bool isBatteryLow()
 {
     return digitalRead(cBatteryLowPin);
@@ -20,6 +20,9 @@
 //
 
 
+#include <stdint.h>
+
+
 /// The hardware component to access the hardware of the feeder.
 ///
 namespace Hardware {
@@ -41,6 +44,29 @@ bool isBatteryLow();
 ///
 bool isProgrammingMode();
 
+/// Enable the input for the interrupt output of the RTC.
+///
+/// A pin change interrupt counts the rising edges on the input, which
+/// are the pulses of the RTC second interrupt.
+///
+void enableRtcInterruptInput();
+
+/// Get the number of rising edges on the RTC interrupt input.
+///
+/// The counter wraps around after 65536 edges.
+///
+uint16_t getRtcPulseCount();
+
+/// Check if the RTC holds its interrupt output active.
+///
+/// The second interrupt only pulses the output for 1/64 s. If the output
+/// stays active for longer, a flag like the alarm flag holds it. This
+/// check needs no I2C access, and reports each hold only once.
+///
+/// @return `true` once for each rising edge where the output is held.
+///
+bool checkRtcInterruptHeld();
+
 /// Send the done signal.
 ///
 /// This function never returns because the done signal
@@ -0,0 +1,87 @@
+#pragma once
+//
+// Lucky Resistor's BCD Codec
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <Arduino.h>
+
+
+namespace lr {
+
+
+/// Conversions between binary values and BCD format.
+///
+/// Besides the conversion of single bytes, there are block conversions
+/// for the register blocks of real time clocks. An 8bit CPU has no wide
+/// registers to convert several bytes at once, so they work byte by byte,
+/// with a constant mask per byte. The host uses the same code.
+///
+/// All values have to be valid: BCD digits from 0 to 9 and binary values
+/// from 0 to 99.
+///
+namespace Bcd {
+
+
+/// Convert a BCD byte into binary format.
+///
+constexpr uint8_t decode(uint8_t bcd)
+{
+    return (bcd&0xf)+((bcd>>4)*10);
+}
+
+/// Convert a binary value into BCD format.
+///
+constexpr uint8_t encode(uint8_t value)
+{
+    return (value%10)+((value/10)<<4);
+}
+
+/// Convert a block of BCD bytes into binary format.
+///
+/// @param bcd The BCD bytes.
+/// @param valueOut The array for the binary values.
+/// @param count The number of bytes.
+/// @param valueMasks The bits of the BCD values for each byte. Other bits,
+///    like flags in a register, are removed.
+///
+inline void decodeBlock(const uint8_t *bcd, uint8_t *valueOut, uint8_t count, const uint8_t *valueMasks)
+{
+    for (uint8_t i = 0; i < count; ++i) {
+        valueOut[i] = decode(bcd[i] & valueMasks[i]);
+    }
+}
+
+/// Convert a block of binary values into BCD format.
+///
+/// @param value The binary values.
+/// @param bcdOut The array for the BCD bytes.
+/// @param count The number of bytes.
+///
+inline void encodeBlock(const uint8_t *value, uint8_t *bcdOut, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; ++i) {
+        bcdOut[i] = encode(value[i]);
+    }
+}
+
+
+}
+}
+
@@ -40,16 +40,47 @@ static const uint16_t cSecondsPerMinute = 60;
     
 // The number of days for a regular year.
 static const uint32_t cDaysPerNormalYear = 365;
+
+// The first and last year which can be stored.
+static const uint16_t cFirstYear = 2000;
+static const uint16_t cLastYear = 2255;
+
+// The layout of the packed fields. The date and time fields are ordered
+// from the most to the least significant bits, so two values of the same
+// year can be compared as integers after masking the day of the week.
+static const uint8_t cSecondShift = 0;
+static const uint8_t cMinuteShift = 6;
+static const uint8_t cHourShift = 12;
+static const uint8_t cDayShift = 17;
+static const uint8_t cMonthShift = 22;
+static const uint8_t cDayOfWeekShift = 26;
+static const uint8_t cSixBitMask = 0x3f;
+static const uint8_t cFiveBitMask = 0x1f;
+static const uint8_t cFourBitMask = 0x0f;
+static const uint8_t cThreeBitMask = 0x07;
+static const uint32_t cDateTimeMask = 0x03ffffffUL;
+
+// The number of days in 400 years of the Gregorian calendar.
+static const uint32_t cDaysPerEra = 146097;
+
+// The first year of the era which contains 2000. The day numbers are
+// counted from 1600-03-01, so the leap day is the last day of a year.
+static const uint16_t cEraStartYear = 1600;
+
+// The number of days from 1600-03-01 to 2000-01-01.
+static const uint32_t cDaysFromEraStartTo2000 = 146037;
     
-// Various output formats for the sprintf function.
-static const char cStringFormatISO[] PROGMEM = "%04d-%02d-%02dT%02d:%02d:%02d"; // yyyy-MM-ddThh:mm:ss
-static const char cStringFormatLong[] PROGMEM = "%04d-%02d-%02d %02d:%02d:%02d"; // yyyy-MM-dd hh:mm:ss
-static const char cStringFormatISODate[] PROGMEM = "%04d-%02d-%02d"; // yyyy-MM-dd
-static const char cStringFormatISOBasicDate[] PROGMEM = "%04d%02d%02d"; // yyyyMMdd
-static const char cStringFormatISOTime[] PROGMEM = "%02d:%02d:%02d"; // hh:mm:ss
-static const char cStringFormatISOBasicTime[] PROGMEM = "%02d%02d%02d"; // hhmmss
-static const char cStringFormatShortDate[] PROGMEM = "%02d.%02d."; // dd.MM.
-static const char cStringFormatShortTime[] PROGMEM = "%02d:%02d"; // hh:mm
+// Various output formats for toBuffer(). `Y` is the year with 4 digits,
+// `M`, `D`, `h`, `m` and `s` are month, day, hour, minute and second with
+// 2 digits. All other characters are copied.
+static const char cStringFormatISO[] PROGMEM = "Y-M-DTh:m:s"; // yyyy-MM-ddThh:mm:ss
+static const char cStringFormatLong[] PROGMEM = "Y-M-D h:m:s"; // yyyy-MM-dd hh:mm:ss
+static const char cStringFormatISODate[] PROGMEM = "Y-M-D"; // yyyy-MM-dd
+static const char cStringFormatISOBasicDate[] PROGMEM = "YMD"; // yyyyMMdd
+static const char cStringFormatISOTime[] PROGMEM = "h:m:s"; // hh:mm:ss
+static const char cStringFormatISOBasicTime[] PROGMEM = "hms"; // hhmmss
+static const char cStringFormatShortDate[] PROGMEM = "D.M."; // dd.MM.
+static const char cStringFormatShortTime[] PROGMEM = "h:m"; // hh:mm
 
     
 // Calculate the day of the week.
@@ -79,13 +110,62 @@ static inline uint8_t getMaxDayPerMonth(uint16_t year, uint8_t month)
 }
 
     
-static inline uint32_t getDaysForYear(uint16_t year)
+// Pack the date and time fields. Values out of range are cut to the size of the field.
+static inline uint32_t packFields(uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, uint8_t dayOfWeek)
+{
+    return (static_cast<uint32_t>(month & cFourBitMask) << cMonthShift)
+        | (static_cast<uint32_t>(day & cFiveBitMask) << cDayShift)
+        | (static_cast<uint32_t>(hour & cFiveBitMask) << cHourShift)
+        | (static_cast<uint16_t>(minute & cSixBitMask) << cMinuteShift)
+        | (second & cSixBitMask)
+        | (static_cast<uint32_t>(dayOfWeek & cThreeBitMask) << cDayOfWeekShift);
+}
+
+
+// Get one field from the packed value.
+static inline uint8_t getField(uint32_t fields, uint8_t shift, uint8_t mask)
+{
+    return static_cast<uint8_t>(fields >> shift) & mask;
+}
+
+
+// Write a decimal value with a fixed number of digits.
+static char* writeDecimal(char *buffer, uint16_t value, uint8_t digits)
 {
-    if (isLeapYear(year)) {
-        return cDaysPerNormalYear + 1;
-    } else {
-        return cDaysPerNormalYear;
+    for (uint8_t i = digits; i > 0; --i) {
+        buffer[i-1] = '0' + (value % 10);
+        value /= 10;
     }
+    return buffer + digits;
+}
+
+
+// Calculate the number of days since 2000-01-01 in constant time.
+// Using the days_from_civil algorithm from: http://howardhinnant.github.io/date_algorithms.html
+static uint32_t getDaysSince2000(uint16_t year, uint8_t month, uint8_t day)
+{
+    // Count the years from March, so January and February belong to the previous year.
+    const uint32_t yearOfEra = static_cast<uint32_t>(year - cEraStartYear - (month <= 2 ? 1 : 0));
+    const uint32_t monthOfYear = (month > 2) ? (month - 3) : (month + 9); // 0=March
+    const uint32_t dayOfYear = (153 * monthOfYear + 2) / 5 + day - 1;
+    const uint32_t daysSinceEraStart = yearOfEra * cDaysPerNormalYear + yearOfEra / 4 - yearOfEra / 100 + yearOfEra / 400 + dayOfYear;
+    return daysSinceEraStart - cDaysFromEraStartTo2000;
+}
+
+
+// Calculate the date from the number of days since 2000-01-01 in constant time.
+// Using the civil_from_days algorithm from: http://howardhinnant.github.io/date_algorithms.html
+static void getDateFromDays(uint32_t daysSince2000, uint16_t &year, uint8_t &month, uint8_t &day)
+{
+    const uint32_t daysSinceEraStart = daysSince2000 + cDaysFromEraStartTo2000;
+    const uint32_t era = daysSinceEraStart / cDaysPerEra;
+    const uint32_t dayOfEra = daysSinceEraStart - era * cDaysPerEra;
+    const uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / cDaysPerNormalYear;
+    const uint32_t dayOfYear = dayOfEra - (yearOfEra * cDaysPerNormalYear + yearOfEra / 4 - yearOfEra / 100);
+    const uint32_t monthOfYear = (5 * dayOfYear + 2) / 153; // 0=March
+    day = static_cast<uint8_t>(dayOfYear - (153 * monthOfYear + 2) / 5 + 1);
+    month = static_cast<uint8_t>((monthOfYear < 10) ? (monthOfYear + 3) : (monthOfYear - 9));
+    year = static_cast<uint16_t>(cEraStartYear + era * 400 + yearOfEra + (month <= 2 ? 1 : 0));
 }
 
     
@@ -93,12 +173,13 @@ static inline uint32_t getDaysForYear(uint16_t year)
  
     
 DateTime::DateTime()
-    : _year(2000), _month(1), _day(1), _hour(0), _minute(0), _second(0), _dayOfWeek(6)
+    : _fields(packFields(1, 1, 0, 0, 0, 6)), _yearOffset(0)
 {
 }
 
     
 DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+    : _fields(0), _yearOffset(0)
 {
     setDate(year, month, day);
     setTime(hour, minute, second);
@@ -106,7 +187,7 @@ DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint
 
     
 DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, uint8_t dayOfWeek)
-    : _year(year), _month(month), _day(day), _hour(hour), _minute(minute), _second(second), _dayOfWeek(dayOfWeek)
+    : _fields(packFields(month, day, hour, minute, second, dayOfWeek)), _yearOffset(static_cast<uint8_t>(year - cFirstYear))
 {
 }
 
@@ -118,12 +199,8 @@ DateTime::~DateTime()
     
 bool DateTime::operator==(const DateTime &other) const
 {
-    return _second != other._second &&
-        _minute != other._minute &&
-        _hour != other._hour &&
-        _day != other._day &&
-        _month != other._month &&
-        _year != other._year;
+    return _yearOffset == other._yearOffset &&
+        (_fields & cDateTimeMask) == (other._fields & cDateTimeMask);
 }
 
 
@@ -135,140 +212,109 @@ bool DateTime::operator!=(const DateTime &other) const
 
 bool DateTime::operator<(const DateTime &other) const
 {
-    if (_year != other._year) {
-        return _year < other._year;
-    } else if (_month != other._month) {
-        return _month < other._month;
-    } else if (_day != other._day) {
-        return _day < other._day;
-    } else if (_hour != other._hour) {
-        return _hour < other._hour;
-    } else if (_minute != other._minute) {
-        return _minute < other._minute;
-    } else {
-        return _second < other._second;
+    if (_yearOffset != other._yearOffset) {
+        return _yearOffset < other._yearOffset;
     }
+    return (_fields & cDateTimeMask) < (other._fields & cDateTimeMask);
 }
 
 
 bool DateTime::operator<=(const DateTime &other) const
 {
-    return operator<(other) || operator==(other);
+    return !other.operator<(*this);
 }
 
 
 bool DateTime::operator>(const DateTime &other) const
 {
-    if (_year != other._year) {
-        return _year > other._year;
-    } else if (_month != other._month) {
-        return _month > other._month;
-    } else if (_day != other._day) {
-        return _day > other._day;
-    } else if (_hour != other._hour) {
-        return _hour > other._hour;
-    } else if (_minute != other._minute) {
-        return _minute > other._minute;
-    } else {
-        return _second > other._second;
-    }
+    return other.operator<(*this);
 }
 
 
 bool DateTime::operator>=(const DateTime &other) const
 {
-    return operator>(other) || operator==(other);
+    return !operator<(other);
 }
 
     
 void DateTime::setDate(uint16_t year, uint16_t month, uint16_t day)
 {
     // force all values into valid ranges.
-    if (year < 2000) {
-        _year = 2000;
-    } else if (year > 9999) {
-        _year = 9999;
-    } else {
-        _year = year;
+    if (year < cFirstYear) {
+        year = cFirstYear;
+    } else if (year > cLastYear) {
+        year = cLastYear;
     }
     if (month < 1) {
-        _month = 1;
+        month = 1;
     } else if (month > 12) {
-        _month = 12;
-    } else {
-        _month = month;
+        month = 12;
     }
-    const uint8_t maxDayPerMonth = getMaxDayPerMonth(_year, _month);
+    const uint8_t maxDayPerMonth = getMaxDayPerMonth(year, month);
     if (day < 1) {
-        _day = 1;
+        day = 1;
     } else if (day > maxDayPerMonth) {
-        _day = maxDayPerMonth;
-    } else {
-        _day = day;
+        day = maxDayPerMonth;
     }
-    _dayOfWeek = calculateDayOfWeek(_year, _month, _day);
+    _yearOffset = static_cast<uint8_t>(year - cFirstYear);
+    _fields = packFields(month, day, getHour(), getMinute(), getSecond(), calculateDayOfWeek(year, month, day));
 }
 
     
 void DateTime::setTime(uint8_t hour, uint8_t minute, uint8_t second)
 {
     if (hour > 23) {
-        _hour = 23;
-    } else {
-        _hour = hour;
+        hour = 23;
     }
     if (minute > 59) {
-        _minute = 59;
-    } else {
-        _minute = minute;
+        minute = 59;
     }
     if (second > 59) {
-        _second = 59;
-    } else {
-        _second = second;
+        second = 59;
     }
+    _fields = packFields(getMonth(), getDay(), hour, minute, second, getDayOfWeek());
 }
 
     
 uint16_t DateTime::getYear() const
 {
-    return _year;
+    return cFirstYear + _yearOffset;
 }
 
 
 uint8_t DateTime::getMonth() const
 {
-    return _month;
+    return getField(_fields, cMonthShift, cFourBitMask);
 }
 
 
 uint8_t DateTime::getDay() const
 {
-    return _day;
+    return getField(_fields, cDayShift, cFiveBitMask);
 }
 
 
 uint8_t DateTime::getDayOfWeek() const
 {
-    return _dayOfWeek;
+    return getField(_fields, cDayOfWeekShift, cThreeBitMask);
 }
 
 
 uint8_t DateTime::getHour() const
 {
-    return _hour;
+    return getField(_fields, cHourShift, cFiveBitMask);
 }
 
 
 uint8_t DateTime::getMinute() const
 {
-    return _minute;
+    return getField(_fields, cMinuteShift, cSixBitMask);
 }
 
 
 uint8_t DateTime::getSecond() const
 {
-    return _second;
+    return getField(_fields, cSecondShift, cSixBitMask);
 }
 
     
@@ -292,69 +338,68 @@ int32_t DateTime::secondsTo(const DateTime &other) const
     
 uint32_t DateTime::toSecondsSince2000() const
 {
-    // This calculation will require some CPU cycles. It is an
-    // programmatic solution, no mathematical one.
-
-    uint32_t seconds = 0;
-    for (uint16_t year = 2000; year < _year; ++year) {
-        seconds += (getDaysForYear(year) * static_cast<uint32_t>(cSecondsPerDay));
-    }
-    for (uint8_t month = 1; month < _month; ++month) {
-        seconds += (static_cast<uint32_t>(getMaxDayPerMonth(_year, month)) * static_cast<uint32_t>(cSecondsPerDay));
-    }
-    seconds += static_cast<uint32_t>(_day-1) * static_cast<uint32_t>(cSecondsPerDay);
-    seconds += static_cast<uint32_t>(_hour) * static_cast<uint32_t>(cSecondsPerHour);
-    seconds += static_cast<uint32_t>(_minute) * static_cast<uint32_t>(cSecondsPerMinute);
-    seconds += static_cast<uint32_t>(_second);
+    uint32_t seconds = getDaysSince2000(getYear(), getMonth(), getDay()) * cSecondsPerDay;
+    seconds += static_cast<uint32_t>(getHour()) * static_cast<uint32_t>(cSecondsPerHour);
+    seconds += static_cast<uint32_t>(getMinute()) * static_cast<uint32_t>(cSecondsPerMinute);
+    seconds += static_cast<uint32_t>(getSecond());
     return seconds;
 }
 
     
 bool DateTime::isFirst() const
 {
-    return _year == 2000 && _month == 1 && _day == 1 && _hour == 0 && _minute == 0 && _second == 0;
+    return _yearOffset == 0 && (_fields & cDateTimeMask) == packFields(1, 1, 0, 0, 0, 0);
 }
     
     
 String DateTime::toString(Format format) const
 {
-    char buffer[20]; // longest format.
+    char buffer[cMaximumFormatLength+1];
+    return String(toBuffer(buffer, format));
+}
+
+
+const char* DateTime::toBuffer(char *buffer, Format format) const
+{
+    const char *formatString = cStringFormatISO;
     switch (format) {
-        case Format::ISO:
-            sprintf_P(buffer, cStringFormatISO, _year, _month, _day, _hour, _minute, _second);
-            break;
-        case Format::Long:
-            sprintf_P(buffer, cStringFormatLong, _year, _month, _day, _hour, _minute, _second);
-            break;
-        case Format::ISODate:
-            sprintf_P(buffer, cStringFormatISODate, _year, _month, _day);
-            break;
-        case Format::ISOBasicDate:
-            sprintf_P(buffer, cStringFormatISOBasicDate, _year, _month, _day);
-            break;
-        case Format::ISOTime:
-            sprintf_P(buffer, cStringFormatISOTime, _hour, _minute, _second);
-            break;
-        case Format::ISOBasicTime:
-            sprintf_P(buffer, cStringFormatISOBasicTime, _hour, _minute, _second);
-            break;
-        case Format::ShortDate:
-            sprintf_P(buffer, cStringFormatShortDate, _day, _month);
-            break;
-        case Format::ShortTime:
-            sprintf_P(buffer, cStringFormatShortTime, _hour, _minute);
-            break;
+        case Format::ISO: formatString = cStringFormatISO; break;
+        case Format::Long: formatString = cStringFormatLong; break;
+        case Format::ISODate: formatString = cStringFormatISODate; break;
+        case Format::ISOBasicDate: formatString = cStringFormatISOBasicDate; break;
+        case Format::ISOTime: formatString = cStringFormatISOTime; break;
+        case Format::ISOBasicTime: formatString = cStringFormatISOBasicTime; break;
+        case Format::ShortDate: formatString = cStringFormatShortDate; break;
+        case Format::ShortTime: formatString = cStringFormatShortTime; break;
     }
-    return String(buffer);
+    char *output = buffer;
+    char c;
+    while ((c = pgm_read_byte(formatString++)) != '\0') {
+        switch (c) {
+            case 'Y': output = writeDecimal(output, getYear(), 4); break;
+            case 'M': output = writeDecimal(output, getMonth(), 2); break;
+            case 'D': output = writeDecimal(output, getDay(), 2); break;
+            case 'h': output = writeDecimal(output, getHour(), 2); break;
+            case 'm': output = writeDecimal(output, getMinute(), 2); break;
+            case 's': output = writeDecimal(output, getSecond(), 2); break;
+            default: *output++ = c; break;
+        }
+    }
+    *output = '\0';
+    return buffer;
+}
+
+
+size_t DateTime::printTo(Print &print, Format format) const
+{
+    char buffer[cMaximumFormatLength+1];
+    toBuffer(buffer, format);
+    return print.write(reinterpret_cast<const uint8_t*>(buffer), strlen(buffer));
 }
 
     
 DateTime DateTime::fromSecondsSince2000(uint32_t secondsSince2000)
 {
-    // This calculation will require some CPU cycles. It is an
-    // programmatic solution, no mathematical one. This function
-    // is approximate 6 times slower than mathematical implementations.
-    
     // Calculate the time
     uint32_t secondsSinceMidnight = secondsSince2000%cSecondsPerDay;
     const uint8_t hours = secondsSinceMidnight/static_cast<uint32_t>(cSecondsPerHour);
@@ -362,23 +407,13 @@ DateTime DateTime::fromSecondsSince2000(uint32_t secondsSince2000)
     const uint8_t minutes = secondsSinceMidnight/static_cast<uint32_t>(cSecondsPerMinute);
     const uint8_t seconds = secondsSinceMidnight % static_cast<uint32_t>(cSecondsPerMinute);
     // Calculate the date
-    uint32_t days = secondsSince2000/static_cast<uint32_t>(cSecondsPerDay);
+    const uint32_t days = secondsSince2000/static_cast<uint32_t>(cSecondsPerDay);
     const uint8_t dayOfWeek = (days+6)%7; // 2000-01-01 was Saturday (6)
-    uint16_t year = 2000;
-    uint32_t daysForThisSection = getDaysForYear(year);
-    while (days >= daysForThisSection) {
-        ++year;
-        days -= daysForThisSection;
-        daysForThisSection = getDaysForYear(year);
-    }
-    uint16_t month = 1;
-    daysForThisSection = getMaxDayPerMonth(year, month);
-    while (days >= daysForThisSection) {
-        ++month;
-        days -= daysForThisSection;
-        daysForThisSection = getMaxDayPerMonth(year, month);
-    }
-    return DateTime(year, month, days+1, hours, minutes, seconds, dayOfWeek);
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    getDateFromDays(days, year, month, day);
+    return DateTime(year, month, day, hours, minutes, seconds, dayOfWeek);
 }
 
     
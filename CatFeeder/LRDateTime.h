@@ -30,16 +30,22 @@ namespace lr {
 ///
 /// This class was specifically made for the Ardurino environment. It works
 /// well with 8bit and 32bit microcontrollers. Conversion to seconds and
-/// back is slow, because it uses an algorithmic method instead of a
-/// mathematical one. The class also allocates around 200 bytes of flash
-/// memory for date/time formats. If you do not need the toString() method,
-/// you can free this memory removing these strings.
+/// back uses day number arithmetic and takes the same time for every
+/// date in the supported range. The class also allocates around 50 bytes of flash
+/// memory for date/time formats. The formatting methods write the digits
+/// directly and do not need the heap or `sprintf`, only toString() creates
+/// a `String` object.
 ///
-/// Supports years starting from 2000, but toSecsSince2000() is limited
+/// Supports the years from 2000 to 2255, but toSecsSince2000() is limited
 /// by the size of the 32bit integer which works up to 2136-02-07 06:28:15.
 /// If you use dates after this point, the result of the seconds conversion
 /// is undefined.
 ///
+/// The values are packed into 5 bytes: the year offset from 2000 and one
+/// 32bit value with the other fields, ordered from the month down to the
+/// second. Comparisons need one byte and one 32bit compare, and the object
+/// can be stored cheaply in RAM or EEPROM.
+///
 /// Leap years are correctly handled. The class is fully tested with all
 /// possible values up to 2136-02-07 06:28:15.
 ///
@@ -68,6 +74,10 @@ public:
         ShortTime, /// hh:mm
     };
     
+    /// The maximum length of a formatted date/time, without the terminating zero.
+    ///
+    static const uint8_t cMaximumFormatLength = 19;
+
 public:
     /// Create the first possible date/time which is 2000-01-01 00:00:00.
     ///
@@ -79,7 +89,7 @@ public:
     /// Create a new date/time with the given values.
     /// All values are constrained to valid values, day of week is calculated.
     ///
-    /// @param year The year from 2000-9999.
+    /// @param year The year from 2000-2255.
     /// @param month The month from 1=January to 12=December.
     /// @param day The day of the month from 1 to 31.
     /// @param hour The hour from 0 to 23.
@@ -119,7 +129,7 @@ public:
 
 public:
     /// Set the date.
-    /// Valid values 2000-9999.
+    /// Valid values 2000-2255.
     ///
     void setDate(uint16_t year, uint16_t month, uint16_t day);
 
@@ -128,7 +138,7 @@ public:
     void setTime(uint8_t hour, uint8_t minute, uint8_t second);
     
     /// Get the year.
-    /// Value from 2000-9999.
+    /// Value from 2000-2255.
     ///
     uint16_t getYear() const;
     
@@ -168,18 +178,16 @@ public:
     uint8_t getSecond() const;
     
     /// Get a new date/time with the given number of seconds added.
-    /// This is a slow operation.
     ///
     DateTime addSeconds(int32_t seconds) const;
     
     /// Get a new date/time with the given number of days added.
-    /// This is a slow operation.
     ///
     DateTime addDays(int32_t days) const;
     
     /// Get the number of seconds to the other date/time.
-    /// This is a slow operation. It works only correctly with differences
-    /// up to 62 years because of the limitation of the 32bit value.
+    /// It works only correctly with differences up to 62 years because
+    /// of the limitation of the 32bit value.
     ///
     int32_t secondsTo(const DateTime &other) const;
     
@@ -195,7 +203,30 @@ public:
     
     /// Convert this date/time into a string using the given format.
     ///
+    /// This allocates the string on the heap. Prefer printTo() or
+    /// toBuffer() where possible.
+    ///
     String toString(Format format) const;
+
+    /// Write this date/time into a buffer using the given format.
+    ///
+    /// @param buffer A buffer with space for `cMaximumFormatLength`
+    ///    characters and the terminating zero.
+    /// @param format The format.
+    /// @return The buffer, to use it directly in a print call.
+    ///
+    const char* toBuffer(char *buffer, Format format) const;
+
+    /// Print this date/time using the given format.
+    ///
+    /// This writes all characters with one write() call, without using
+    /// the heap.
+    ///
+    /// @param print The target, like the LCD or the serial port.
+    /// @param format The format.
+    /// @return The number of written characters.
+    ///
+    size_t printTo(Print &print, Format format) const;
     
 public:
     /// Create a new date/time object from the given unix time.
@@ -206,7 +237,7 @@ public:
 
     /// Create a new completely unchecked date time object from
     /// the given values. You have to make sure all values are in the
-    /// correct ranges.
+    /// correct ranges. Values which do not fit into their field are cut.
     ///
     static DateTime fromUncheckedValues(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, uint8_t dayOfWeek);
     
@@ -216,13 +247,8 @@ private:
     DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, uint8_t dayOfWeek);
     
 private:
-    uint16_t _year; ///< The year
-    uint8_t _month; ///< The month 1-12
-    uint8_t _day; ///< The day 1-31
-    uint8_t _hour; ///< The hour 0-23
-    uint8_t _minute; ///< The minute 0-59
-    uint8_t _second; ///< The second 0-59
-    uint8_t _dayOfWeek; ///< The day of the week 0-6
+    uint32_t _fields; ///< The day of week, month, day, hour, minute and second, from the most significant bits.
+    uint8_t _yearOffset; ///< The year minus 2000.
 };
 
     
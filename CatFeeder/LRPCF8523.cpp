@@ -20,8 +20,10 @@
 #include "LRPCF8523.h"
 
 
-#include <Wire.h>
-#include <avr/pgmspace.h>
+#include "LRTwi.h"
+#include "Trace.h"
+
+#include <string.h>
 
 
 namespace lr {
@@ -41,70 +43,170 @@ struct DateTimeRegister {
 };
 
 
+/// The value bits of the time registers, starting with the seconds.
+///
+static const uint8_t cDateTimeValueMasks[] = {0x7f, 0x7f, 0x3f, 0x3f, 0x07, 0x1f, 0xff};
+
 /// The chip address in the I2C bus.
 ///
 static const uint8_t cChipAddress = 0x68;
 
-/// The mapping between interrupts and registers/bits
+/// The number of registers of the chip.
 ///
-static const uint16_t cInterruptMapping[] PROGMEM = {
-//    abcd : a = enable register, b = enable bit, c = flag register, d = flag bit
-    0x0214, // Second
-    0x0113, // Alarm
-    0x0008, // Correction
-    0x1217, // WatchDogTimerA
-    0x1116, // CountdownTimerA
-    0x1015, // CountdownTimerB
-    0x2123, // BatterySwitchOver
-    0x2022, // BatteryLow
-};
-
+static const uint8_t cRegisterCount = 0x14;
 
 /// The year base.
 ///
 static uint16_t gYearBase;
+
+/// The state of the register shadow.
+///
+enum class ShadowState : uint8_t {
+    Disabled, ///< The shadow is not used.
+    Invalid, ///< The shadow is used, but has to be read from the chip.
+    Valid ///< The shadow matches the chip.
+};
+
+/// The number of registers covered by the shadow, starting at Control1.
+///
+static const uint8_t cShadowSize = 0x10;
+
+/// The value written into the chip to reset it.
+///
+static const uint8_t cSoftwareResetValue = 0x58;
+
+/// The current state of the register shadow.
+///
+static ShadowState gShadowState = ShadowState::Disabled;
+
+/// The shadow of the control, alarm, offset and clock out registers.
+///
+/// The time registers are part of the array to keep the addressing
+/// simple, but they are never used. Volatile flags are stored as 1,
+/// which is the value that keeps them unchanged on a write.
+///
+static uint8_t gShadow[cShadowSize];
  
    
-/// Function to convert BCD format into binary format.
+/// Check if a register is covered by the shadow.
 ///
-static inline uint8_t convertBcdToBin(const uint8_t bcd)
+static inline bool isShadowRegister(uint8_t index)
 {
-    return (bcd&0xf)+((bcd>>4)*10);
+    return index < static_cast<uint8_t>(Register::Seconds)
+        || (index >= static_cast<uint8_t>(Register::MinuteAlarm) && index < cShadowSize);
 }
 
-    
-/// Function to convert binary to BCD format.
+
+/// Get the bits of a register which are changed by the chip itself.
+///
+/// These flags are cleared by writing a 0 or are read-only, so writing
+/// a 1 keeps their current state.
+///
+static inline uint8_t getVolatileBits(uint8_t index)
+{
+    if (index == static_cast<uint8_t>(Register::Control2)) {
+        return 0b11111000; // AF, SF, CTBF, CTAF, WTAF
+    } else if (index == static_cast<uint8_t>(Register::Control3)) {
+        return 0b00001100; // BLF, BSF
+    }
+    return 0;
+}
+
+
+/// Store a value in the shadow, with all volatile bits set.
+///
+static inline void storeShadow(uint8_t index, uint8_t value)
+{
+    gShadow[index] = value | getVolatileBits(index);
+}
+
+
+/// Update the shadow after a register was written.
 ///
-static inline uint8_t convertBinToBcd(const uint8_t bin)
+static void writeThroughShadow(uint8_t index, uint8_t value)
 {
-    return (bin%10)+((bin/10)<<4);
+    if (gShadowState != ShadowState::Valid || !isShadowRegister(index)) {
+        return;
+    }
+    if (index == static_cast<uint8_t>(Register::Control1) && value == cSoftwareResetValue) {
+        gShadowState = ShadowState::Invalid; // The chip resets all registers.
+    } else {
+        storeShadow(index, value);
+    }
+}
+
+
+/// Make sure the shadow is valid, if it is used.
+///
+/// If the registers can not be read, the shadow stays invalid and the
+/// next call tries again.
+///
+/// @return `true` if the shadow can be used.
+///
+static bool prepareShadow()
+{
+    if (gShadowState == ShadowState::Invalid) {
+        // Read the control registers and the alarm to clock out registers.
+        const uint8_t controlCount = static_cast<uint8_t>(Register::Seconds);
+        const uint8_t alarmIndex = static_cast<uint8_t>(Register::MinuteAlarm);
+        if (!readRegister(Register::Control1, gShadow, controlCount)
+            || !readRegister(Register::MinuteAlarm, gShadow + alarmIndex, cShadowSize - alarmIndex)) {
+            return false;
+        }
+        for (uint8_t i = 0; i < cShadowSize; ++i) {
+            storeShadow(i, gShadow[i]);
+        }
+        gShadowState = ShadowState::Valid;
+    }
+    return gShadowState == ShadowState::Valid;
+}
+
+
+/// Change the masked bits of a register.
+///
+/// If the register is in the shadow, the old value is taken from the
+/// shadow and there is only one write. Registers with no volatile bits
+/// are not written at all if the value does not change.
+///
+static void modifyRegister(Register reg, uint8_t value, uint8_t mask)
+{
+    const uint8_t index = static_cast<uint8_t>(reg);
+    uint8_t data;
+    if (isShadowRegister(index) && prepareShadow()) {
+        data = gShadow[index];
+        const uint8_t newData = (data & (~mask)) | (value & mask);
+        if (newData == data && (getVolatileBits(index) & mask) == 0) {
+            return; // Nothing changes.
+        }
+        data = newData;
+    } else {
+        if (!readRegister(reg, &data, 1)) { // Read the old value.
+            return; // Do not write a value based on a failed read.
+        }
+        data &= (~mask); // Remove the masked bits.
+        data |= (value & mask); // Add the new value.
+    }
+    writeRegister(reg, data); // Write the combined value.
 }
 
 
 uint8_t readRegister(Register reg)
 {
-    // Address the register
-    Wire.beginTransmission(cChipAddress);
-    Wire.write(static_cast<uint8_t>(reg));
-    Wire.endTransmission();
-    // Read one byte from the register.
-    Wire.requestFrom(cChipAddress, 1u);
-    const uint8_t data = Wire.read();
+    uint8_t data;
+    readRegister(reg, &data, 1);
     return data;
 }
 
 
-void readRegister(Register reg, uint8_t *valueOut, uint8_t count)
+bool readRegister(Register reg, uint8_t *valueOut, uint8_t count)
 {
-    // Address the register
-    Wire.beginTransmission(cChipAddress);
-    Wire.write(static_cast<uint8_t>(reg));
-    Wire.endTransmission();
-    // Read the register values
-    Wire.requestFrom(cChipAddress, count);
-    for (uint8_t i = 0; i < count; ++i) {
-        valueOut[i] = Wire.read();
+    // Address the register and read the values after a repeated start.
+    const uint8_t address = static_cast<uint8_t>(reg);
+    if (Twi::transfer(cChipAddress, &address, 1, valueOut, count) != Twi::Status::Success) {
+        memset(valueOut, 0, count);
+        return false;
     }
+    return true;
 }
 
 
@@ -116,49 +218,44 @@ bool readFlag(Register reg, uint8_t bitMask)
 
 void writeRegister(Register reg, uint8_t value)
 {
-    // Address the register and write the value
-    Wire.beginTransmission(cChipAddress);
-    Wire.write(static_cast<uint8_t>(reg));
-    Wire.write(value);
-    Wire.endTransmission();
+    writeRegister(reg, &value, 1);
 }
 
 
 void writeRegister(Register reg, const uint8_t *valueIn, uint8_t count)
 {
-    // Address the register and write the values
-    Wire.beginTransmission(cChipAddress);
-    Wire.write(static_cast<uint8_t>(reg));
+    // Address the register and write the values.
+    uint8_t data[cRegisterCount + 1];
+    data[0] = static_cast<uint8_t>(reg);
+    memcpy(data + 1, valueIn, count);
+    if (Twi::transfer(cChipAddress, data, count + 1) != Twi::Status::Success) {
+        // The chip may have taken a part of the values, read it again before the next use.
+        if (gShadowState == ShadowState::Valid) {
+            gShadowState = ShadowState::Invalid;
+        }
+        return;
+    }
     for (uint8_t i = 0; i < count; ++i) {
-        Wire.write(valueIn[i]);
+        writeThroughShadow(static_cast<uint8_t>(reg) + i, valueIn[i]);
     }
-    Wire.endTransmission();
 }
 
 
 void writeRegister(Register reg, uint8_t value, uint8_t mask)
 {
-    value &= mask; // Remove not maked bits.
-    uint8_t data = readRegister(reg); // Read the old value.
-    data &= (~mask); // Remove the masked bits.
-    data |= value; // Add the new value.
-    writeRegister(reg, data); // Write the combined value.
+    modifyRegister(reg, value, mask);
 }
 
 
 void setFlag(Register reg, uint8_t bitMask)
 {
-    uint8_t data = readRegister(reg); // Read the old value.
-    data |= bitMask; // Set the flag.
-    writeRegister(reg, data); // Write the combined value.
+    modifyRegister(reg, bitMask, bitMask);
 }
 
 
 void clearFlag(Register reg, uint8_t bitMask)
 {
-    uint8_t data = readRegister(reg); // Read the old value.
-    data &= (~bitMask); // Clear the flag
-    writeRegister(reg, data); // Write the combined value.
+    modifyRegister(reg, 0, bitMask);
 }
 
 
@@ -177,41 +274,83 @@ void begin(uint16_t yearBase)
     gYearBase = yearBase;
 }
 
+
+void enableShadow()
+{
+    if (gShadowState == ShadowState::Disabled) {
+        gShadowState = ShadowState::Invalid;
+    }
+}
+
+
+void disableShadow()
+{
+    gShadowState = ShadowState::Disabled;
+}
+
     
+/// Convert the values of the time registers into a date/time object.
+///
+static DateTime convertToDateTime(const DateTimeRegister &data)
+{
+    DateTimeRegister values;
+    Bcd::decodeBlock(reinterpret_cast<const uint8_t*>(&data), reinterpret_cast<uint8_t*>(&values),
+        sizeof(DateTimeRegister), cDateTimeValueMasks);
+    return DateTime::fromUncheckedValues(
+        static_cast<uint16_t>(values.year)+gYearBase,
+        values.month,
+        values.day,
+        values.hours,
+        values.minutes,
+        values.seconds,
+        values.dayOfWeek);
+}
+
+
 DateTime getDateTime()
 {
+    LR_TRACE_SCOPE("PCF8523::getDateTime");
     // Use the struct to read all registers in one batch.
     DateTimeRegister data;
     readRegister(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
     // Convert these values into a date object.
-    return DateTime::fromUncheckedValues(
-        static_cast<uint16_t>(convertBcdToBin(data.year))+gYearBase,
-        convertBcdToBin(data.month&0x1f),
-        convertBcdToBin(data.day&0x3f),
-        convertBcdToBin(data.hours&0x3f),
-        convertBcdToBin(data.minutes&0x7f),
-        convertBcdToBin(data.seconds&0x7f),
-        data.dayOfWeek&0x7);
+    return convertToDateTime(data);
 }
 
     
-void setDateTime(const DateTime &dateTime)
+/// Convert a date/time object into the values of the time registers.
+///
+/// @return `false` if the year is out of the range of the chip.
+///
+static bool convertFromDateTime(const DateTime &dateTime, DateTimeRegister &data)
 {
     // Basic year check
     const uint16_t newYear = dateTime.getYear();
     if (newYear < gYearBase || newYear >= (gYearBase+100)) {
-        return; // Ignore this call.
+        return false;
     }
+    // Prepare all registers which will be written
+    DateTimeRegister values;
+    values.seconds = dateTime.getSecond();
+    values.minutes = dateTime.getMinute();
+    values.hours = dateTime.getHour();
+    values.day = dateTime.getDay();
+    values.dayOfWeek = dateTime.getDayOfWeek();
+    values.month = dateTime.getMonth();
+    values.year = newYear-gYearBase;
+    Bcd::encodeBlock(reinterpret_cast<const uint8_t*>(&values), reinterpret_cast<uint8_t*>(&data),
+        sizeof(DateTimeRegister));
+    return true;
+}
+
+
+void setDateTime(const DateTime &dateTime)
+{
     // Use a struct to write all registers in one batch.
     DateTimeRegister data;
-    // Prepare all registers which will be written
-    data.seconds = convertBinToBcd(dateTime.getSecond());
-    data.minutes = convertBinToBcd(dateTime.getMinute());
-    data.hours = convertBinToBcd(dateTime.getHour());
-    data.day = convertBinToBcd(dateTime.getDay());
-    data.dayOfWeek = dateTime.getDayOfWeek();
-    data.month = convertBinToBcd(dateTime.getMonth());
-    data.year = convertBinToBcd(dateTime.getYear()-gYearBase);
+    if (!convertFromDateTime(dateTime, data)) {
+        return; // Ignore this call.
+    }
     // Write all registers.
     writeRegister(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
 }
@@ -219,49 +358,49 @@ void setDateTime(const DateTime &dateTime)
 
 uint8_t getAlarmMinute()
 {
-    return convertBcdToBin(readRegister(Register::MinuteAlarm) & 0b01111111);
+    return AlarmMinuteField::read();
 }
 
 
 uint8_t getAlarmHour()
 {
-    return convertBcdToBin(readRegister(Register::HourAlarm) & 0b00111111);
+    return AlarmHourField::read();
 }
 
 
 uint8_t getAlarmDay()
 {
-    return convertBcdToBin(readRegister(Register::DayAlarm) & 0b00111111);
+    return AlarmDayField::read();
 }
 
 
 uint8_t getAlarmDayOfWeek()
 {
-    return convertBcdToBin(readRegister(Register::WeekdayAlarm) & 0b00000111);  
+    return AlarmDayOfWeekField::read();
 }
 
 
 void setAlarmMinute(uint8_t minute)
 {
-    writeRegister(Register::MinuteAlarm, convertBinToBcd(minute), 0b01111111);
+    AlarmMinuteField::write(minute);
 }
 
 
 void setAlarmHour(uint8_t hour)
 {
-    writeRegister(Register::HourAlarm, convertBinToBcd(hour), 0b00111111);
+    AlarmHourField::write(hour);
 }
 
 
 void setAlarmDay(uint8_t day)
 {
-    writeRegister(Register::DayAlarm, convertBinToBcd(day), 0b00111111);
+    AlarmDayField::write(day);
 }
 
 
 void setAlarmDayOfWeek(uint8_t dayOfWeek)
 {
-    writeRegister(Register::WeekdayAlarm, convertBinToBcd(dayOfWeek), 0b00000111);
+    AlarmDayOfWeekField::write(dayOfWeek);
 }
 
 
@@ -284,7 +423,13 @@ void setAlarmMode(AlarmMode alarmMode)
 {
     const uint8_t alarmRegisterCount = 4;
     uint8_t alarmRegister[alarmRegisterCount];
-    readRegister(Register::MinuteAlarm, alarmRegister, alarmRegisterCount);
+    if (prepareShadow()) {
+        for (uint8_t i = 0; i < alarmRegisterCount; ++i) {
+            alarmRegister[i] = gShadow[static_cast<uint8_t>(Register::MinuteAlarm) + i];
+        }
+    } else if (!readRegister(Register::MinuteAlarm, alarmRegister, alarmRegisterCount)) {
+        return; // Do not write values based on a failed read.
+    }
     for (uint8_t i = 0; i < alarmRegisterCount; ++i) {
         if ((static_cast<uint8_t>(alarmMode) & (1<<i)) != 0) {
             // Enable this alarm by setting the highest bit to 0
@@ -300,101 +445,290 @@ void setAlarmMode(AlarmMode alarmMode)
 
 bool isAlarm()
 {
-    return readFlag(Control2::AF);
+    return AlarmFlagField::read() != 0;
 }
 
 
 void clearAlarm()
 {
-    clearFlag(Control2::AF);
+    AlarmFlagField::write(0);
 }
 
 
 bool isBackupBatteryLow()
 {
-    return readFlag(Control3::BLF);
+    return BatteryLowFlagField::read() != 0;
 }
 
 
 ClockFrequency getClockOutFrequency()
 {
-    return static_cast<ClockFrequency>(readRegister(Register::TimerAndClockOut)>>3);
+    return static_cast<ClockFrequency>(ClockOutFrequencyField::read());
 }
 
 
 void setClockOutFrequency(ClockFrequency freq)
 {
-    const uint8_t value = (static_cast<uint8_t>(freq) << 3);
-    const uint8_t mask = static_cast<uint8_t>(TimerAndClockOut::COFmask);
-    writeRegister(Register::TimerAndClockOut, value, mask);
+    ClockOutFrequencyField::write(static_cast<uint8_t>(freq));
 }
 
 
 PowerManagement getPowerManagement()
 {
-    return static_cast<PowerManagement>(readRegister(Register::Control3)>>5);
+    return static_cast<PowerManagement>(PowerManagementField::read());
 }
 
 
 void setPowerManagement(PowerManagement powerManagement)
 {
-    const uint8_t value = (static_cast<uint8_t>(powerManagement) << 5);
-    const uint8_t mask = static_cast<uint8_t>(Control3::PMmask);
-    writeRegister(Register::Control3, value, mask);
+    PowerManagementField::write(static_cast<uint8_t>(powerManagement));
 }
 
 
-bool isInterruptEnabled(Interrupt interrupt)
+void reset()
 {
-    const uint16_t entry = pgm_read_word(cInterruptMapping + static_cast<uint8_t>(interrupt));
-    const Register enableRegister = static_cast<Register>(entry>>12);
-    const uint8_t enableMask = (1<<((entry>>8)&0x0f));
-    return (readRegister(enableRegister) & enableMask) != 0;
+    writeRegister(Register::Control1, cSoftwareResetValue);
 }
 
 
-void enableInterrupt(Interrupt interrupt)
+Snapshot::Snapshot()
+    : _registers()
 {
-    const uint16_t entry = pgm_read_word(cInterruptMapping + static_cast<uint8_t>(interrupt));
-    const Register enableRegister = static_cast<Register>(entry>>12);
-    const uint8_t enableMask = (1<<((entry>>8)&0x0f));
-    writeRegister(enableRegister, enableMask, enableMask);
 }
 
 
-void disableInterrupt(Interrupt interrupt)
+void Snapshot::read()
 {
-    const uint16_t entry = pgm_read_word(cInterruptMapping + static_cast<uint8_t>(interrupt));
-    const Register enableRegister = static_cast<Register>(entry>>12);
-    const uint8_t enableMask = (1<<((entry>>8)&0x0f));
-    writeRegister(enableRegister, static_cast<uint8_t>(0x00), enableMask);
+    read(Register::Control1, Register::WeekdayAlarm);
 }
 
 
-bool isInterruptFlagSet(Interrupt interrupt)
+void Snapshot::read(Register first, Register last)
 {
-    const uint16_t entry = pgm_read_word(cInterruptMapping + static_cast<uint8_t>(interrupt));
-    const Register flagRegister = static_cast<Register>((entry>>4)&0x0f);
-    const uint8_t flagMask = (1<<(entry&0x0f));
-    return (readRegister(flagRegister) & flagMask) != 0;    
+    LR_TRACE_SCOPE("PCF8523::Snapshot::read");
+    const uint8_t firstIndex = static_cast<uint8_t>(first);
+    const uint8_t lastIndex = static_cast<uint8_t>(last);
+    if (firstIndex > lastIndex || lastIndex >= cRegisterCount) {
+        return; // Ignore this call.
+    }
+    readRegister(first, _registers + firstIndex, lastIndex - firstIndex + 1);
 }
 
 
-void clearInterruptFlag(Interrupt interrupt)
+DateTime Snapshot::getDateTime() const
 {
-    const uint16_t entry = pgm_read_word(cInterruptMapping + static_cast<uint8_t>(interrupt));
-    const Register flagRegister = static_cast<Register>((entry>>4)&0x0f);
-    const uint8_t flagMask = (1<<(entry&0x0f));
-    writeRegister(flagRegister, static_cast<uint8_t>(0x00), flagMask);
+    return convertToDateTime(*reinterpret_cast<const DateTimeRegister*>(_registers + static_cast<uint8_t>(Register::Seconds)));
 }
 
 
-void reset()
+uint8_t Snapshot::getAlarmMinute() const
+{
+    return AlarmMinuteField::decode(getRegister(AlarmMinuteField::cRegister));
+}
+
+
+uint8_t Snapshot::getAlarmHour() const
+{
+    return AlarmHourField::decode(getRegister(AlarmHourField::cRegister));
+}
+
+
+bool Snapshot::isAlarm() const
+{
+    return AlarmFlagField::decode(getRegister(AlarmFlagField::cRegister)) != 0;
+}
+
+
+bool Snapshot::isAlarmTime() const
+{
+    const uint8_t hourMask = AlarmHourField::cMask;
+    const uint8_t minuteMask = AlarmMinuteField::cMask;
+    return (getRegister(Register::Hours) & hourMask) == (getRegister(Register::HourAlarm) & hourMask)
+        && (getRegister(Register::Minutes) & minuteMask) == (getRegister(Register::MinuteAlarm) & minuteMask);
+}
+
+
+bool Snapshot::isBackupBatteryLow() const
+{
+    return BatteryLowFlagField::decode(getRegister(BatteryLowFlagField::cRegister)) != 0;
+}
+
+
+bool Snapshot::isInterruptEnabled(Interrupt interrupt) const
+{
+    const RegisterBit bit = getInterruptEnableBit(interrupt);
+    return (getRegister(bit.reg) & bit.mask) != 0;
+}
+
+
+void Snapshot::disableInterrupt(Interrupt interrupt)
+{
+    const RegisterBit bit = getInterruptEnableBit(interrupt);
+    _registers[static_cast<uint8_t>(bit.reg)] &= ~bit.mask;
+    writeRegister(bit.reg, getRegister(bit.reg));
+}
+
+
+void Snapshot::clearAlarm()
+{
+    _registers[static_cast<uint8_t>(AlarmFlagField::cRegister)] &= ~AlarmFlagField::cMask;
+    writeRegister(AlarmFlagField::cRegister, getRegister(AlarmFlagField::cRegister));
+}
+
+
+uint8_t Snapshot::getRegister(Register reg) const
+{
+    return _registers[static_cast<uint8_t>(reg)];
+}
+
+
+StagedWrite::StagedWrite()
+    : _values(), _masks()
+{
+}
+
+
+void StagedWrite::setRegister(Register reg, uint8_t value, uint8_t mask)
+{
+    const uint8_t index = static_cast<uint8_t>(reg);
+    if (index >= cRegisterCount) {
+        return; // Ignore this call.
+    }
+    _values[index] = (_values[index] & (~mask)) | (value & mask);
+    _masks[index] |= mask;
+}
+
+
+void StagedWrite::setDateTime(const DateTime &dateTime)
+{
+    DateTimeRegister data;
+    if (!convertFromDateTime(dateTime, data)) {
+        return; // Ignore this call.
+    }
+    const uint8_t *values = reinterpret_cast<const uint8_t*>(&data);
+    for (uint8_t i = 0; i < sizeof(DateTimeRegister); ++i) {
+        setRegister(static_cast<Register>(static_cast<uint8_t>(Register::Seconds) + i), values[i]);
+    }
+}
+
+
+void StagedWrite::setAlarmMinute(uint8_t minute)
+{
+    setField<AlarmMinuteField>(minute);
+}
+
+
+void StagedWrite::setAlarmHour(uint8_t hour)
+{
+    setField<AlarmHourField>(hour);
+}
+
+
+void StagedWrite::setAlarmDay(uint8_t day)
+{
+    setField<AlarmDayField>(day);
+}
+
+
+void StagedWrite::setAlarmDayOfWeek(uint8_t dayOfWeek)
+{
+    setField<AlarmDayOfWeekField>(dayOfWeek);
+}
+
+
+void StagedWrite::setAlarmMode(AlarmMode alarmMode)
+{
+    const uint8_t alarmRegisterCount = 4;
+    for (uint8_t i = 0; i < alarmRegisterCount; ++i) {
+        const Register reg = static_cast<Register>(static_cast<uint8_t>(Register::MinuteAlarm) + i);
+        // The highest bit set to 0 enables this alarm.
+        const uint8_t value = ((static_cast<uint8_t>(alarmMode) & (1<<i)) != 0) ? 0 : 0b10000000;
+        setRegister(reg, value, 0b10000000);
+    }
+}
+
+
+void StagedWrite::clearAlarm()
+{
+    setField<AlarmFlagField>(0);
+}
+
+
+void StagedWrite::setClockOutFrequency(ClockFrequency freq)
+{
+    setField<ClockOutFrequencyField>(static_cast<uint8_t>(freq));
+}
+
+
+void StagedWrite::setPowerManagement(PowerManagement powerManagement)
 {
-    writeRegister(Register::Control1, 0x58);
+    setField<PowerManagementField>(static_cast<uint8_t>(powerManagement));
 }
 
 
+void StagedWrite::flush()
+{
+    LR_TRACE_SCOPE("PCF8523::StagedWrite::flush");
+    // Complete the partially staged registers with the current values.
+    for (uint8_t i = 0; i < cRegisterCount; ++i) {
+        if (_masks[i] != 0 && _masks[i] != 0xff) {
+            uint8_t data;
+            if (isShadowRegister(i) && prepareShadow()) {
+                data = gShadow[i];
+            } else if (!readRegister(static_cast<Register>(i), &data, 1)) {
+                // Do not write a value based on a failed read.
+                _masks[i] = 0;
+                continue;
+            }
+            _values[i] = (data & (~_masks[i])) | _values[i];
+            _masks[i] = 0xff;
+        }
+        // Drop registers which do not change.
+        if (_masks[i] != 0 && isShadowRegister(i) && gShadowState == ShadowState::Valid
+            && _values[i] == gShadow[i] && getVolatileBits(i) == 0) {
+            _masks[i] = 0;
+        }
+    }
+    // Write the runs of staged registers.
+    const uint8_t maximumGap = 2; // A longer gap costs more than a new transaction.
+    uint8_t first = 0;
+    while (first < cRegisterCount) {
+        if (_masks[first] == 0) {
+            ++first;
+            continue;
+        }
+        uint8_t end = first + 1;
+        while (end < cRegisterCount) {
+            if (_masks[end] != 0) {
+                ++end;
+                continue;
+            }
+            // Check if the gap to the next staged register can be filled from the shadow.
+            uint8_t gapEnd = end;
+            while (gapEnd < cRegisterCount && _masks[gapEnd] == 0
+                && (gapEnd - end) < maximumGap && isShadowRegister(gapEnd)
+                && gShadowState == ShadowState::Valid) {
+                ++gapEnd;
+            }
+            if (gapEnd >= cRegisterCount || _masks[gapEnd] == 0) {
+                break;
+            }
+            for (uint8_t i = end; i < gapEnd; ++i) {
+                _values[i] = gShadow[i];
+            }
+            end = gapEnd;
+        }
+        writeRegister(static_cast<Register>(first), _values + first, end - first);
+        first = end;
+    }
+    // Start with an empty set.
+    for (uint8_t i = 0; i < cRegisterCount; ++i) {
+        _masks[i] = 0;
+    }
+}
+
+
+
 void printAllRegisterValues()
 {
     const uint8_t rtcRegisterCount = 0x14;
@@ -22,17 +22,28 @@
 
 #include <Arduino.h>
 
+#include "LRBcd.h"
 #include "LRDateTime.h"
 
 
 namespace lr {
 
-/// This is a simple driver library for the NXP PCF8523 chip.
+/// This is a driver library for the NXP PCF8523 chip.
 ///
-/// It has very efficient getDateTime() and setDateTime() methods.
-/// All other methods are implemented with comfort in mind, not
-/// speed. If you need speed, please consider to implement your
-/// own code for programming the chip.
+/// The driver keeps the I2C traffic low, because every transaction adds
+/// to the awake time of the device:
+///
+/// - The time and the alarm registers are read and written in burst
+///   transactions, with the BCD block conversions of `LRBcd.h`.
+/// - With enableShadow(), a write-through copy of the configuration
+///   registers turns masked writes into a single write.
+/// - `Snapshot` reads a range of registers in one transaction and serves
+///   several getters from it.
+/// - `StagedWrite` collects changes of several registers and writes them
+///   with the fewest transactions in flush().
+///
+/// The functions for single settings, like setAlarmMode(), are still
+/// available for code which only changes one setting.
 ///
 namespace PCF8523 {
 
@@ -94,6 +105,8 @@ enum class Interrupt : uint8_t {
     
 /// Initialize the real time clock driver.
 ///
+/// The driver uses `Twi`, call `Twi::begin()` first.
+///
 /// @param yearBase The year base which is used for the RTC.
 ///    The RTC stores the year only with two digits, plus one
 ///    additional bit for the next century. If you set the
@@ -102,6 +115,24 @@ enum class Interrupt : uint8_t {
 ///
 void begin(uint16_t yearBase = 2000);
 
+/// Enable the register shadow.
+///
+/// The driver keeps a write-through copy of the control, alarm, offset
+/// and clock out registers. It is read from the chip with the first
+/// masked write after this call and after a software reset. Masked writes
+/// and flag changes use the copy and need a single write instead of a
+/// read and a write. The time registers and the volatile flags, like
+/// AF and BLF, are always read from the chip.
+///
+/// Only enable the shadow if no other code changes the registers of the
+/// chip without this driver.
+///
+void enableShadow();
+
+/// Disable the register shadow.
+///
+void disableShadow();
+
 /// Get the current date/time.
 ///
 DateTime getDateTime();
@@ -184,29 +215,29 @@ void setPowerManagement(PowerManagement powerManagement);
 
 /// Check if an interrupt is enabled.
 ///
-bool isInterruptEnabled(Interrupt interrupt);
+inline bool isInterruptEnabled(Interrupt interrupt);
 
 /// Enable an interrupt
 ///
-void enableInterrupt(Interrupt interrupt);
+inline void enableInterrupt(Interrupt interrupt);
 
 /// Disable an Interrupt
 ///
-void disableInterrupt(Interrupt interrupt);
+inline void disableInterrupt(Interrupt interrupt);
 
 /// Check if an interrupt flag was set.
 ///
 /// /note This does not work the same way for all interrupts, 
 /// please check the data sheet for details. 
 ///
-bool isInterruptFlagSet(Interrupt interrupt);
+inline bool isInterruptFlagSet(Interrupt interrupt);
 
 /// Clear an interrupt flag.
 ///
 /// /note This does not work the same way for all interrupts, 
 /// please check the data sheet for details. 
 ///
-void clearInterruptFlag(Interrupt interrupt);
+inline void clearInterruptFlag(Interrupt interrupt);
 
 
 /// Do a software reset
@@ -301,11 +332,15 @@ uint8_t readRegister(Register reg);
 
 /// Read multiple registers from the chip.
 ///
+/// The registers are read in one transaction on the TWI bus. If the
+/// transaction fails, all values are set to zero.
+///
 /// @param reg The first register to read.
 /// @param valueOut An array of bytes to write the register values to.
 /// @param count The number of registers to read.
+/// @return `true` on success, `false` if the transaction failed.
 ///
-void readRegister(Register reg, uint8_t *valueOut, uint8_t count);
+bool readRegister(Register reg, uint8_t *valueOut, uint8_t count);
 
 /// Read a flag from a register.
 ///
@@ -324,6 +359,9 @@ void writeRegister(Register reg, uint8_t value);
 
 /// Write a multiple register values to the chip.
 ///
+/// If the transaction fails, the register shadow is read again before
+/// its next use.
+///
 /// @param reg The start register for the write.
 /// @param valueIn A pointer to the array of values to write.
 /// @param count The number of registers to write.
@@ -333,6 +371,8 @@ void writeRegister(Register reg, const uint8_t *valueIn, uint8_t count);
 /// Write a few bits in a single register.
 /// 
 /// This reads the register first, masks the result and writes the register.
+/// If the register shadow is enabled, the register is not read. If the
+/// register can not be read, nothing is written.
 ///
 /// @param reg The register to write into.
 /// @param value The new value.
@@ -365,19 +405,378 @@ void setFlag(Register reg, uint8_t bitMask);
 void clearFlag(Register reg, uint8_t bitMask);
 
 
-// Helper methods to simplify the code.
-inline bool readFlag(Control1 flag) { return readFlag(Register::Control1, static_cast<uint8_t>(flag)); }
-inline bool readFlag(Control2 flag) { return readFlag(Register::Control2, static_cast<uint8_t>(flag)); }
-inline bool readFlag(Control3 flag) { return readFlag(Register::Control3, static_cast<uint8_t>(flag)); }
-inline bool setFlag(Control1 flag) { setFlag(Register::Control1, static_cast<uint8_t>(flag)); }
-inline bool setFlag(Control2 flag) { setFlag(Register::Control2, static_cast<uint8_t>(flag)); }
-inline bool setFlag(Control3 flag) { setFlag(Register::Control3, static_cast<uint8_t>(flag)); }
-inline bool clearFlag(Control1 flag) { clearFlag(Register::Control1, static_cast<uint8_t>(flag)); }
-inline bool clearFlag(Control2 flag) { clearFlag(Register::Control2, static_cast<uint8_t>(flag)); }
-inline bool clearFlag(Control3 flag) { clearFlag(Register::Control3, static_cast<uint8_t>(flag)); }
-inline bool writeFlag(Control1 flag, bool enabled) { writeFlag(Register::Control1, static_cast<uint8_t>(flag), enabled); }
-inline bool writeFlag(Control2 flag, bool enabled) { writeFlag(Register::Control2, static_cast<uint8_t>(flag), enabled); }
-inline bool writeFlag(Control3 flag, bool enabled) { writeFlag(Register::Control3, static_cast<uint8_t>(flag), enabled); }
+/// Get the register of a flag.
+///
+constexpr Register getFlagRegister(Control1) { return Register::Control1; }
+constexpr Register getFlagRegister(Control2) { return Register::Control2; }
+constexpr Register getFlagRegister(Control3) { return Register::Control3; }
+
+// Helper methods to simplify the code, for the flags of Control1-3.
+template<typename tFlag>
+inline auto readFlag(tFlag flag) -> decltype(getFlagRegister(flag), bool()) {
+    return readFlag(getFlagRegister(flag), static_cast<uint8_t>(flag));
+}
+template<typename tFlag>
+inline auto setFlag(tFlag flag) -> decltype(getFlagRegister(flag), void()) {
+    setFlag(getFlagRegister(flag), static_cast<uint8_t>(flag));
+}
+template<typename tFlag>
+inline auto clearFlag(tFlag flag) -> decltype(getFlagRegister(flag), void()) {
+    clearFlag(getFlagRegister(flag), static_cast<uint8_t>(flag));
+}
+template<typename tFlag>
+inline auto writeFlag(tFlag flag, bool enabled) -> decltype(getFlagRegister(flag), void()) {
+    writeFlag(getFlagRegister(flag), static_cast<uint8_t>(flag), enabled);
+}
+
+
+// Register Fields
+// ---------------------------------------------------------------------------
+
+/// The format of the value in a register field.
+///
+enum class FieldFormat : uint8_t {
+    Binary, ///< The value is a binary number.
+    Bcd, ///< The value is in BCD format.
+};
+
+/// A single bit in a register.
+///
+struct RegisterBit {
+    Register reg; ///< The register.
+    uint8_t mask; ///< The mask for the bit, zero if the bit does not exist.
+};
+
+/// The descriptor of a bit field in a register.
+///
+/// All parameters are part of the type, so every access compiles into
+/// a register access with constant masks and shifts.
+///
+/// @tparam tRegister The register with the field.
+/// @tparam tOffset The position of the lowest bit.
+/// @tparam tWidth The number of bits.
+/// @tparam tFormat The format of the value.
+///
+template<Register tRegister, uint8_t tOffset, uint8_t tWidth, FieldFormat tFormat = FieldFormat::Binary>
+struct Field
+{
+    /// The register with the field.
+    ///
+    static const Register cRegister = tRegister;
+
+    /// The mask for the field in the register.
+    ///
+    static const uint8_t cMask = static_cast<uint8_t>(((1u<<tWidth)-1u)<<tOffset);
+
+    /// Get the value of the field from a register value.
+    ///
+    static constexpr uint8_t decode(uint8_t registerValue) {
+        return (tFormat == FieldFormat::Bcd)
+            ? Bcd::decode((registerValue & cMask) >> tOffset)
+            : static_cast<uint8_t>((registerValue & cMask) >> tOffset);
+    }
+
+    /// Get the register bits for a value of the field.
+    ///
+    static constexpr uint8_t encode(uint8_t value) {
+        return static_cast<uint8_t>((((tFormat == FieldFormat::Bcd) ? Bcd::encode(value) : value) << tOffset) & cMask);
+    }
+
+    /// Get the field as single bit.
+    ///
+    static constexpr RegisterBit getBit() {
+        return RegisterBit{tRegister, cMask};
+    }
+
+    /// Read the value of the field from the chip.
+    ///
+    static uint8_t read() {
+        return decode(readRegister(tRegister));
+    }
+
+    /// Write the value of the field to the chip.
+    ///
+    /// The other bits of the register are kept, see writeRegister().
+    ///
+    static void write(uint8_t value) {
+        writeRegister(tRegister, encode(value), cMask);
+    }
+};
+
+// The fields used by the driver.
+using CorrectionInterruptEnableField = Field<Register::Control1, 0, 1>;
+using AlarmInterruptEnableField = Field<Register::Control1, 1, 1>;
+using SecondInterruptEnableField = Field<Register::Control1, 2, 1>;
+using CountdownTimerBInterruptEnableField = Field<Register::Control2, 0, 1>;
+using CountdownTimerAInterruptEnableField = Field<Register::Control2, 1, 1>;
+using WatchDogTimerAInterruptEnableField = Field<Register::Control2, 2, 1>;
+using AlarmFlagField = Field<Register::Control2, 3, 1>;
+using SecondFlagField = Field<Register::Control2, 4, 1>;
+using CountdownTimerBFlagField = Field<Register::Control2, 5, 1>;
+using CountdownTimerAFlagField = Field<Register::Control2, 6, 1>;
+using WatchDogTimerAFlagField = Field<Register::Control2, 7, 1>;
+using BatteryLowInterruptEnableField = Field<Register::Control3, 0, 1>;
+using BatterySwitchOverInterruptEnableField = Field<Register::Control3, 1, 1>;
+using BatteryLowFlagField = Field<Register::Control3, 2, 1>;
+using BatterySwitchOverFlagField = Field<Register::Control3, 3, 1>;
+using PowerManagementField = Field<Register::Control3, 5, 3>;
+using AlarmMinuteField = Field<Register::MinuteAlarm, 0, 7, FieldFormat::Bcd>;
+using AlarmHourField = Field<Register::HourAlarm, 0, 6, FieldFormat::Bcd>;
+using AlarmDayField = Field<Register::DayAlarm, 0, 6, FieldFormat::Bcd>;
+using AlarmDayOfWeekField = Field<Register::WeekdayAlarm, 0, 3, FieldFormat::Bcd>;
+using ClockOutFrequencyField = Field<Register::TimerAndClockOut, 3, 3>;
+using TimerAInterruptModeField = Field<Register::TimerAndClockOut, 7, 1>; // Also for the second interrupt.
+
+/// Get the enable bit of an interrupt.
+///
+constexpr RegisterBit getInterruptEnableBit(Interrupt interrupt)
+{
+    return (interrupt == Interrupt::Second) ? SecondInterruptEnableField::getBit()
+        : (interrupt == Interrupt::Alarm) ? AlarmInterruptEnableField::getBit()
+        : (interrupt == Interrupt::Correction) ? CorrectionInterruptEnableField::getBit()
+        : (interrupt == Interrupt::WatchDogTimerA) ? WatchDogTimerAInterruptEnableField::getBit()
+        : (interrupt == Interrupt::CountdownTimerA) ? CountdownTimerAInterruptEnableField::getBit()
+        : (interrupt == Interrupt::CountdownTimerB) ? CountdownTimerBInterruptEnableField::getBit()
+        : (interrupt == Interrupt::BatterySwitchOver) ? BatterySwitchOverInterruptEnableField::getBit()
+        : BatteryLowInterruptEnableField::getBit();
+}
+
+/// Get the flag of an interrupt.
+///
+/// The correction interrupt has no flag, for it a zero mask is returned.
+///
+constexpr RegisterBit getInterruptFlagBit(Interrupt interrupt)
+{
+    return (interrupt == Interrupt::Second) ? SecondFlagField::getBit()
+        : (interrupt == Interrupt::Alarm) ? AlarmFlagField::getBit()
+        : (interrupt == Interrupt::Correction) ? RegisterBit{Register::Control2, 0}
+        : (interrupt == Interrupt::WatchDogTimerA) ? WatchDogTimerAFlagField::getBit()
+        : (interrupt == Interrupt::CountdownTimerA) ? CountdownTimerAFlagField::getBit()
+        : (interrupt == Interrupt::CountdownTimerB) ? CountdownTimerBFlagField::getBit()
+        : (interrupt == Interrupt::BatterySwitchOver) ? BatterySwitchOverFlagField::getBit()
+        : BatteryLowFlagField::getBit();
+}
+
+
+inline bool isInterruptEnabled(Interrupt interrupt)
+{
+    return readFlag(getInterruptEnableBit(interrupt).reg, getInterruptEnableBit(interrupt).mask);
+}
+
+
+inline void enableInterrupt(Interrupt interrupt)
+{
+    setFlag(getInterruptEnableBit(interrupt).reg, getInterruptEnableBit(interrupt).mask);
+}
+
+
+inline void disableInterrupt(Interrupt interrupt)
+{
+    clearFlag(getInterruptEnableBit(interrupt).reg, getInterruptEnableBit(interrupt).mask);
+}
+
+
+inline bool isInterruptFlagSet(Interrupt interrupt)
+{
+    return getInterruptFlagBit(interrupt).mask != 0
+        && readFlag(getInterruptFlagBit(interrupt).reg, getInterruptFlagBit(interrupt).mask);
+}
+
+
+inline void clearInterruptFlag(Interrupt interrupt)
+{
+    if (getInterruptFlagBit(interrupt).mask != 0) {
+        clearFlag(getInterruptFlagBit(interrupt).reg, getInterruptFlagBit(interrupt).mask);
+    }
+}
+
+
+// Snapshot
+// ---------------------------------------------------------------------------
+
+/// A copy of the control, time and alarm registers.
+///
+/// The snapshot reads a range of the registers Control1 to WeekdayAlarm
+/// in one burst transaction, and all getters are served from these values.
+/// This replaces several register reads, each with its own transaction.
+/// A getter is only valid if its registers were part of a read range.
+///
+class Snapshot
+{
+public:
+    /// Create an empty snapshot with all values set to zero.
+    ///
+    Snapshot();
+
+public:
+    /// Read the registers Control1 to WeekdayAlarm.
+    ///
+    void read();
+
+    /// Read a range of registers.
+    ///
+    /// @param first The first register to read.
+    /// @param last The last register to read, up to WeekdayAlarm.
+    ///
+    void read(Register first, Register last);
+
+    /// Get the date/time from the time registers.
+    ///
+    DateTime getDateTime() const;
+
+    /// Get the minute of the alarm.
+    ///
+    uint8_t getAlarmMinute() const;
+
+    /// Get the hour of the alarm.
+    ///
+    uint8_t getAlarmHour() const;
+
+    /// Check if the alarm flag is set.
+    ///
+    bool isAlarm() const;
+
+    /// Check if hour and minute of the time match the alarm.
+    ///
+    /// This needs the time and the alarm registers.
+    ///
+    bool isAlarmTime() const;
+
+    /// Check if the backup battery is low.
+    ///
+    bool isBackupBatteryLow() const;
+
+    /// Check if an interrupt is enabled.
+    ///
+    bool isInterruptEnabled(Interrupt interrupt) const;
+
+    /// Disable an interrupt in the chip.
+    ///
+    /// This writes the read value of the register without the enable bit,
+    /// without reading the register again.
+    ///
+    void disableInterrupt(Interrupt interrupt);
+
+    /// Clear the alarm flag in the chip.
+    ///
+    /// This writes the read value of Control2 without the alarm flag,
+    /// without reading the register again.
+    ///
+    void clearAlarm();
+
+    /// Get the value of a register.
+    ///
+    uint8_t getRegister(Register reg) const;
+
+private:
+    /// The number of registers in the snapshot.
+    ///
+    static const uint8_t cRegisterCount = 0x0e;
+
+private:
+    uint8_t _registers[cRegisterCount]; ///< The register values, by address.
+};
+
+
+// Staged Write
+// ---------------------------------------------------------------------------
+
+/// A set of register changes which are written together.
+///
+/// Changes to the registers Control1 to TimerAndClockOut are collected
+/// and flush() writes them with the fewest possible burst writes. Bits
+/// which are not changed are taken from the register shadow, or read
+/// from the chip if the shadow is disabled. Short gaps between changed
+/// registers are filled from the shadow, so they do not split the write.
+///
+/// A software reset can not be staged, call reset() before.
+///
+class StagedWrite
+{
+public:
+    /// Create an empty set of changes.
+    ///
+    StagedWrite();
+
+public:
+    /// Stage a few bits of a register.
+    ///
+    /// @param reg The register to change, up to TimerAndClockOut.
+    /// @param value The new value.
+    /// @param mask The mask. Each 1 bit in the mask set is written.
+    ///
+    void setRegister(Register reg, uint8_t value, uint8_t mask = 0xff);
+
+    /// Stage the value of a field.
+    ///
+    template<typename tField>
+    void setField(uint8_t value) {
+        setRegister(tField::cRegister, tField::encode(value), tField::cMask);
+    }
+
+    /// Stage the date/time.
+    ///
+    void setDateTime(const DateTime &dateTime);
+
+    /// Stage the minute of the alarm.
+    ///
+    void setAlarmMinute(uint8_t minute);
+
+    /// Stage the hour of the alarm.
+    ///
+    void setAlarmHour(uint8_t hour);
+
+    /// Stage the day of the alarm.
+    ///
+    void setAlarmDay(uint8_t day);
+
+    /// Stage the day of week of the alarm.
+    ///
+    void setAlarmDayOfWeek(uint8_t dayOfWeek);
+
+    /// Stage the alarm mode.
+    ///
+    void setAlarmMode(AlarmMode alarmMode);
+
+    /// Stage clearing the alarm flag.
+    ///
+    void clearAlarm();
+
+    /// Stage the clock out frequency.
+    ///
+    void setClockOutFrequency(ClockFrequency freq);
+
+    /// Stage the power management configuration.
+    ///
+    void setPowerManagement(PowerManagement powerManagement);
+
+    /// Stage enabling an interrupt.
+    ///
+    void enableInterrupt(Interrupt interrupt) {
+        setRegister(getInterruptEnableBit(interrupt).reg, 0xff, getInterruptEnableBit(interrupt).mask);
+    }
+
+    /// Stage clearing an interrupt flag.
+    ///
+    void clearInterruptFlag(Interrupt interrupt) {
+        setRegister(getInterruptFlagBit(interrupt).reg, 0, getInterruptFlagBit(interrupt).mask);
+    }
+
+    /// Write all staged changes to the chip.
+    ///
+    /// After this call, the set of changes is empty.
+    ///
+    void flush();
+
+private:
+    /// The number of registers which can be staged.
+    ///
+    static const uint8_t cRegisterCount = 0x10;
+
+private:
+    uint8_t _values[cRegisterCount]; ///< The staged values, by address.
+    uint8_t _masks[cRegisterCount]; ///< The staged bits, by address.
+};
 
 
 }
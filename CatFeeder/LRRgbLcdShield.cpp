@@ -0,0 +1,297 @@
+//
+// Lucky Resistor's RGB LCD Shield Driver
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include "LRRgbLcdShield.h"
+
+
+namespace lr {
+
+
+/// The address of the MCP23017 on the shield.
+///
+static const uint8_t cAddress = 0x20;
+
+/// The registers of the MCP23017 in bank mode 1, with the registers of
+/// each port in a separate block.
+///
+enum : uint8_t {
+    cRegisterIoDirA = 0x00,
+    cRegisterIoCon = 0x05,
+    cRegisterGpPuA = 0x06,
+    cRegisterGpioA = 0x09,
+    cRegisterIoDirB = 0x10,
+    cRegisterGpioB = 0x19,
+};
+
+/// The address of IOCON in the default bank mode 0, which is unused in bank mode 1.
+///
+static const uint8_t cRegisterIoConBank0 = 0x0b;
+
+/// The configuration for IOCON: bank mode 1 and no sequential operation.
+///
+/// Without sequential operation, the register pointer stays at the register,
+/// so all bytes of a write go to the same port.
+///
+static const uint8_t cIoConfiguration = 0xa0;
+
+/// The pins of the LCD on port B.
+///
+static const uint8_t cRsBit = _BV(7);
+static const uint8_t cEnableBit = _BV(5);
+static const uint8_t cDataBits[4] = {_BV(4), _BV(3), _BV(2), _BV(1)}; // D4-D7
+
+/// The backlight LEDs, red and green on port A, blue on port B. They are active low.
+///
+static const uint8_t cRedBitA = _BV(6);
+static const uint8_t cGreenBitA = _BV(7);
+static const uint8_t cBlueBitB = _BV(0);
+
+/// The buttons on port A.
+///
+static const uint8_t cButtonMask = 0x1f;
+
+/// The LCD commands.
+///
+enum : uint8_t {
+    cCommandClearDisplay = 0x01,
+    cCommandEntryModeSet = 0x04,
+    cCommandDisplayControl = 0x08,
+    cCommandFunctionSet = 0x20,
+    cCommandSetCgramAddress = 0x40,
+    cCommandSetDdramAddress = 0x80,
+};
+
+/// The flags for the LCD commands.
+///
+enum : uint8_t {
+    cEntryLeft = 0x02,
+    cDisplayOn = 0x04,
+    cCursorOn = 0x02,
+    cBlinkOn = 0x01,
+    cTwoLines = 0x08,
+};
+
+
+RgbLcdShield::RgbLcdShield()
+    : _portWrites(), _nextPortWrite(0), _portA(0), _portB(0), _displayControl(0), _rowCount(1)
+{
+}
+
+
+void RgbLcdShield::begin(uint8_t columns, uint8_t rows)
+{
+    (void)columns;
+    _rowCount = rows;
+    // Switch to bank mode 1. After a power-on reset, the first write sets IOCON.
+    // If the expander is already in bank mode 1, it ignores the first write
+    // and the second one sets IOCON again.
+    writeRegisters(cRegisterIoConBank0, &cIoConfiguration, 1);
+    writeRegisters(cRegisterIoCon, &cIoConfiguration, 1);
+    // Set the latches first, all LEDs on and all LCD lines low.
+    _portA = 0;
+    _portB = 0;
+    writeRegisters(cRegisterGpioA, &_portA, 1);
+    writeRegisters(cRegisterGpioB, &_portB, 1);
+    // Buttons are inputs with pull-up, the LEDs and the LCD are outputs.
+    const uint8_t directionA = static_cast<uint8_t>(~(cRedBitA|cGreenBitA));
+    const uint8_t directionB = 0x00;
+    writeRegisters(cRegisterIoDirA, &directionA, 1);
+    writeRegisters(cRegisterIoDirB, &directionB, 1);
+    writeRegisters(cRegisterGpPuA, &cButtonMask, 1);
+    // Wait for the LCD to power up.
+    Twi::flush();
+    delayMicroseconds(50000);
+    // Switch the LCD into 4 bit mode.
+    write4bits(0x03);
+    Twi::flush();
+    delayMicroseconds(4500);
+    write4bits(0x03);
+    Twi::flush();
+    delayMicroseconds(4500);
+    write4bits(0x03);
+    Twi::flush();
+    delayMicroseconds(150);
+    write4bits(0x02);
+    command(cCommandFunctionSet | ((rows > 1) ? cTwoLines : 0));
+    _displayControl = cDisplayOn;
+    command(cCommandDisplayControl | _displayControl);
+    clear();
+    command(cCommandEntryModeSet | cEntryLeft);
+}
+
+
+void RgbLcdShield::clear()
+{
+    command(cCommandClearDisplay);
+    // The command takes up to 1.52ms after the last nibble.
+    Twi::flush();
+    delayMicroseconds(2000);
+}
+
+
+void RgbLcdShield::blink()
+{
+    _displayControl |= cBlinkOn;
+    command(cCommandDisplayControl | _displayControl);
+}
+
+
+void RgbLcdShield::noBlink()
+{
+    _displayControl &= ~cBlinkOn;
+    command(cCommandDisplayControl | _displayControl);
+}
+
+
+void RgbLcdShield::noCursor()
+{
+    _displayControl &= ~cCursorOn;
+    command(cCommandDisplayControl | _displayControl);
+}
+
+
+void RgbLcdShield::setBacklight(uint8_t color)
+{
+    _portA |= cRedBitA|cGreenBitA;
+    _portB |= cBlueBitB;
+    if ((color & 0b001) != 0) {
+        _portA &= ~cRedBitA;
+    }
+    if ((color & 0b010) != 0) {
+        _portA &= ~cGreenBitA;
+    }
+    if ((color & 0b100) != 0) {
+        _portB &= ~cBlueBitB;
+    }
+    writeRegisters(cRegisterGpioA, &_portA, 1);
+    writeRegisters(cRegisterGpioB, &_portB, 1);
+}
+
+
+void RgbLcdShield::createChar(uint8_t location, const uint8_t characterMap[])
+{
+    location &= 0x7; // There are only 8 locations.
+    command(cCommandSetCgramAddress | (location << 3));
+    for (uint8_t i = 0; i < 8; ++i) {
+        write(characterMap[i]);
+    }
+    command(cCommandSetDdramAddress); // This resets the location to 0,0.
+}
+
+
+void RgbLcdShield::setCursor(uint8_t column, uint8_t row)
+{
+    static const uint8_t rowOffsets[] = {0x00, 0x40};
+    if (row >= _rowCount) {
+        row = _rowCount - 1;
+    }
+    command(cCommandSetDdramAddress | (column + rowOffsets[row]));
+}
+
+
+uint8_t RgbLcdShield::readButtons()
+{
+    // The read is queued after all pending writes. It sets the register
+    // pointer and reads the port with a repeated start.
+    const uint8_t reg = cRegisterGpioA;
+    uint8_t port;
+    if (Twi::transfer(cAddress, &reg, 1, &port, 1) != Twi::Status::Success) {
+        return 0;
+    }
+    // A pressed button connects the pin to GND.
+    return ~port & cButtonMask;
+}
+
+
+size_t RgbLcdShield::write(uint8_t value)
+{
+    send(value, true);
+    return 1;
+}
+
+
+void RgbLcdShield::command(uint8_t value)
+{
+    send(value, false);
+}
+
+
+void RgbLcdShield::send(uint8_t value, bool isData)
+{
+    // RS and R/W are sent together with the first nibble.
+    if (isData) {
+        _portB |= cRsBit;
+    } else {
+        _portB &= ~cRsBit;
+    }
+    // Both nibbles with their enable pulses are sent in one write.
+    uint8_t data[cNibbleWriteCount * 2];
+    setNibble(value >> 4, data);
+    setNibble(value, data + cNibbleWriteCount);
+    writeRegisters(cRegisterGpioB, data, cNibbleWriteCount * 2);
+}
+
+
+void RgbLcdShield::write4bits(uint8_t value)
+{
+    uint8_t data[cNibbleWriteCount];
+    setNibble(value, data);
+    writeRegisters(cRegisterGpioB, data, cNibbleWriteCount);
+}
+
+
+void RgbLcdShield::setNibble(uint8_t value, uint8_t *data)
+{
+    for (uint8_t i = 0; i < 4; ++i) {
+        if (((value >> i) & 0x1) != 0) {
+            _portB |= cDataBits[i];
+        } else {
+            _portB &= ~cDataBits[i];
+        }
+    }
+    // The LCD latches the nibble with the falling edge of the enable pin.
+    // The port changes with each byte, which takes longer on the bus than
+    // the required setup time and pulse width.
+    _portB &= ~cEnableBit;
+    data[0] = _portB;
+    data[1] = _portB | cEnableBit;
+    data[2] = _portB;
+}
+
+
+void RgbLcdShield::writeRegisters(uint8_t reg, const uint8_t *data, uint8_t count)
+{
+    PortWrite &portWrite = _portWrites[_nextPortWrite];
+    _nextPortWrite = (_nextPortWrite + 1) % cPortWriteCount;
+    // Wait until the previous write with this slot is finished.
+    Twi::wait(portWrite.transaction);
+    if (count > cNibbleWriteCount * 2) {
+        count = cNibbleWriteCount * 2;
+    }
+    portWrite.data[0] = reg;
+    for (uint8_t i = 0; i < count; ++i) {
+        portWrite.data[i + 1] = data[i];
+    }
+    portWrite.transaction.address = cAddress;
+    portWrite.transaction.writeData = portWrite.data;
+    portWrite.transaction.writeCount = count + 1;
+    Twi::submit(portWrite.transaction);
+}
+
+
+}
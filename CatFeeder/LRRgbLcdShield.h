@@ -0,0 +1,174 @@
+#pragma once
+//
+// Lucky Resistor's RGB LCD Shield Driver
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "LRTwi.h"
+
+#include <Arduino.h>
+
+
+namespace lr {
+
+
+/// A driver for the Adafruit RGB LCD shield, using the TWI driver.
+///
+/// The shield connects a HD44780 compatible LCD, the backlight LEDs and
+/// five buttons to a MCP23017 port expander. The driver implements the
+/// part of the Adafruit library which is used by the firmware, with the
+/// same initialisation and the same pin sequence for each nibble.
+///
+/// The state of the output latches is kept in the driver, so a pin change
+/// is a single write to the port, without reading it first. The expander
+/// is switched to bank mode 1 without sequential operation, so all bytes of
+/// a write go to the same port. This way, each byte for the LCD, with both
+/// nibbles and their enable pulses, is a single write of seven bytes. The
+/// writes are queued and sent by the interrupt, while the firmware continues.
+///
+class RgbLcdShield : public Print
+{
+public:
+    /// The button bits, like in the Adafruit library.
+    ///
+    enum Button : uint8_t {
+        ButtonSelect = 0x01,
+        ButtonRight = 0x02,
+        ButtonDown = 0x04,
+        ButtonUp = 0x08,
+        ButtonLeft = 0x10,
+    };
+
+public:
+    /// Create a new driver instance.
+    ///
+    RgbLcdShield();
+
+public:
+    /// Initialize the port expander and the LCD.
+    ///
+    /// @param columns The number of columns of the LCD.
+    /// @param rows The number of rows of the LCD.
+    ///
+    void begin(uint8_t columns, uint8_t rows);
+
+    /// Clear the display and move the cursor to the home position.
+    ///
+    void clear();
+
+    /// Show a blinking block at the cursor position.
+    ///
+    void blink();
+
+    /// Hide the blinking block at the cursor position.
+    ///
+    void noBlink();
+
+    /// Hide the underline cursor.
+    ///
+    void noCursor();
+
+    /// Set the backlight color.
+    ///
+    /// @param color The LEDs to switch on: bit 0 red, bit 1 green and bit 2 blue.
+    ///
+    void setBacklight(uint8_t color);
+
+    /// Define a custom character.
+    ///
+    /// @param location The character code 0-7.
+    /// @param characterMap The 8 rows of the character.
+    ///
+    void createChar(uint8_t location, const uint8_t characterMap[]);
+
+    /// Move the cursor.
+    ///
+    void setCursor(uint8_t column, uint8_t row);
+
+    /// Read the pressed buttons.
+    ///
+    /// @return The bits of the pressed buttons, see `Button`.
+    ///
+    uint8_t readButtons();
+
+    /// Write a character at the cursor position.
+    ///
+    size_t write(uint8_t value) override;
+    using Print::write;
+
+private:
+    /// The number of port values to send one nibble to the LCD.
+    ///
+    static const uint8_t cNibbleWriteCount = 3;
+
+    /// A queued write to a port of the expander.
+    ///
+    struct PortWrite {
+        Twi::Transaction transaction; ///< The transaction for the write.
+        uint8_t data[1 + cNibbleWriteCount * 2]; ///< The register address and the port values.
+    };
+
+    /// The number of port writes which can be queued.
+    ///
+    static const uint8_t cPortWriteCount = 8;
+
+private:
+    /// Send a command to the LCD.
+    ///
+    void command(uint8_t value);
+
+    /// Send a byte to the LCD.
+    ///
+    /// @param value The command or character.
+    /// @param isData `true` for a character, `false` for a command.
+    ///
+    void send(uint8_t value, bool isData);
+
+    /// Send four bits to the LCD and pulse the enable pin.
+    ///
+    void write4bits(uint8_t value);
+
+    /// Set the data pins for a nibble and get the port values to pulse the enable pin.
+    ///
+    /// @param value The nibble in the lower four bits.
+    /// @param data The array for the `cNibbleWriteCount` values of port B.
+    ///
+    void setNibble(uint8_t value, uint8_t *data);
+
+    /// Queue a write to a register of the expander.
+    ///
+    /// @param reg The register.
+    /// @param data The values, which are written one after the other into the register.
+    /// @param count The number of values, up to `cNibbleWriteCount * 2`.
+    ///
+    void writeRegisters(uint8_t reg, const uint8_t *data, uint8_t count);
+
+private:
+    PortWrite _portWrites[cPortWriteCount]; ///< The queued port writes.
+    uint8_t _nextPortWrite; ///< The index of the next port write to use.
+    uint8_t _portA; ///< The output latch of port A.
+    uint8_t _portB; ///< The output latch of port B.
+    uint8_t _displayControl; ///< The display control flags.
+    uint8_t _rowCount; ///< The number of rows.
+};
+
+
+}
+
+
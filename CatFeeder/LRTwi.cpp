@@ -0,0 +1,366 @@
+//
+// Lucky Resistor's TWI Driver
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include "LRTwi.h"
+
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+
+namespace lr {
+namespace Twi {
+
+
+/// The status codes of the TWI unit in master mode.
+///
+enum : uint8_t {
+    cStatusBusError = 0x00, ///< Illegal start or stop condition.
+    cStatusStart = 0x08, ///< A start condition was sent.
+    cStatusRepeatedStart = 0x10, ///< A repeated start condition was sent.
+    cStatusAddressWriteAck = 0x18, ///< SLA+W was sent, ACK received.
+    cStatusAddressWriteNack = 0x20, ///< SLA+W was sent, NACK received.
+    cStatusDataWriteAck = 0x28, ///< A data byte was sent, ACK received.
+    cStatusDataWriteNack = 0x30, ///< A data byte was sent, NACK received.
+    cStatusArbitrationLost = 0x38, ///< The arbitration was lost.
+    cStatusAddressReadAck = 0x40, ///< SLA+R was sent, ACK received.
+    cStatusAddressReadNack = 0x48, ///< SLA+R was sent, NACK received.
+    cStatusDataReadAck = 0x50, ///< A data byte was received, ACK returned.
+    cStatusDataReadNack = 0x58, ///< A data byte was received, NACK returned.
+};
+
+/// The mask for the status bits in TWSR.
+///
+const uint8_t cStatusMask = 0xf8;
+
+/// The control bits to continue with the next step and keep the interrupt enabled.
+///
+const uint8_t cControlNext = _BV(TWEN)|_BV(TWIE)|_BV(TWINT);
+
+/// The time for the start of a transaction in microseconds, besides the bytes.
+///
+const uint16_t cTimeoutMarginMicros = 1000;
+
+
+/// The transactions waiting in the queue.
+///
+static Transaction * volatile gQueueFirst = nullptr;
+static Transaction * volatile gQueueLast = nullptr;
+
+/// The finished transactions with a callback.
+///
+static Transaction * volatile gFinishedFirst = nullptr;
+static Transaction * volatile gFinishedLast = nullptr;
+
+/// The transaction on the bus.
+///
+static Transaction * volatile gActive = nullptr;
+
+/// The index of the next byte to write or read.
+///
+static volatile uint8_t gByteIndex = 0;
+
+/// The time of one byte on the bus in microseconds.
+///
+static uint16_t gByteMicros = 90;
+
+/// The start of the transaction on the bus.
+///
+static volatile uint32_t gStartMicros = 0;
+
+
+/// Append a transaction to a list.
+///
+static inline void appendToList(Transaction * volatile &first, Transaction * volatile &last, Transaction *transaction)
+{
+    transaction->next = nullptr;
+    if (last == nullptr) {
+        first = transaction;
+    } else {
+        last->next = transaction;
+    }
+    last = transaction;
+}
+
+
+/// Remove the first transaction from a list.
+///
+static inline Transaction* takeFirstFromList(Transaction * volatile &first, Transaction * volatile &last)
+{
+    Transaction *transaction = first;
+    if (transaction != nullptr) {
+        first = transaction->next;
+        if (first == nullptr) {
+            last = nullptr;
+        }
+        transaction->next = nullptr;
+    }
+    return transaction;
+}
+
+
+/// Send the start condition for the active transaction.
+///
+/// @param control Additional control bits, like `TWSTO` to end the last transaction.
+///
+static inline void startActive(uint8_t control)
+{
+    gByteIndex = 0;
+    gStartMicros = micros();
+    TWCR = cControlNext|_BV(TWSTA)|control;
+}
+
+
+/// Start the next transaction from the queue.
+///
+/// @param control Additional control bits for the TWI unit.
+///
+static void startNext(uint8_t control)
+{
+    gActive = takeFirstFromList(gQueueFirst, gQueueLast);
+    if (gActive != nullptr) {
+        gActive->status = Status::Active;
+        startActive(control);
+    } else {
+        // Release the bus and disable the interrupt.
+        TWCR = _BV(TWEN)|_BV(TWINT)|control;
+    }
+}
+
+
+/// Finish the active transaction and continue with the next one.
+///
+/// A failed transaction is repeated until all retries are used.
+///
+/// @param status The status of the transaction.
+/// @param control The control bits to end the transaction on the bus.
+///
+static void finishActive(Status status, uint8_t control)
+{
+    Transaction *transaction = gActive;
+    if (status != Status::Success && transaction->failureCount < cRetryCount) {
+        ++transaction->failureCount;
+        startActive(control);
+        return;
+    }
+    transaction->status = status;
+    if (transaction->callback != nullptr) {
+        appendToList(gFinishedFirst, gFinishedLast, transaction);
+    }
+    startNext(control);
+}
+
+
+/// Get the control bits to read the next byte.
+///
+/// The last byte is not acknowledged, to tell the device the read ends.
+///
+static inline uint8_t getReadControl()
+{
+    if (gByteIndex + 1 < gActive->readCount) {
+        return cControlNext|_BV(TWEA);
+    }
+    return cControlNext;
+}
+
+
+/// Send the address for the read part of the active transaction.
+///
+static inline void sendReadAddress()
+{
+    gByteIndex = 0;
+    TWDR = (gActive->address << 1) | 1;
+    TWCR = cControlNext;
+}
+
+
+/// Continue after the address or a byte was written.
+///
+static inline void continueWrite()
+{
+    Transaction *transaction = gActive;
+    if (gByteIndex < transaction->writeCount) {
+        TWDR = transaction->writeData[gByteIndex++];
+        TWCR = cControlNext;
+    } else if (transaction->readCount > 0) {
+        // Read with a repeated start condition.
+        TWCR = cControlNext|_BV(TWSTA);
+    } else {
+        finishActive(Status::Success, _BV(TWSTO));
+    }
+}
+
+
+ISR(TWI_vect)
+{
+    switch (TWSR & cStatusMask) {
+    case cStatusStart:
+        // A transaction without bytes only checks the address.
+        if (gActive->writeCount > 0 || gActive->readCount == 0) {
+            TWDR = gActive->address << 1;
+            TWCR = cControlNext;
+        } else {
+            sendReadAddress();
+        }
+        break;
+    case cStatusRepeatedStart:
+        sendReadAddress();
+        break;
+    case cStatusAddressWriteAck:
+    case cStatusDataWriteAck:
+        continueWrite();
+        break;
+    case cStatusAddressWriteNack:
+    case cStatusAddressReadNack:
+        finishActive(Status::AddressNack, _BV(TWSTO));
+        break;
+    case cStatusDataWriteNack:
+        finishActive(Status::DataNack, _BV(TWSTO));
+        break;
+    case cStatusArbitrationLost:
+        // The bus is released, a new start condition is sent if the bus is free.
+        finishActive(Status::ArbitrationLost, 0);
+        break;
+    case cStatusAddressReadAck:
+        TWCR = getReadControl();
+        break;
+    case cStatusDataReadAck:
+        gActive->readData[gByteIndex++] = TWDR;
+        TWCR = getReadControl();
+        break;
+    case cStatusDataReadNack:
+        gActive->readData[gByteIndex++] = TWDR;
+        finishActive(Status::Success, _BV(TWSTO));
+        break;
+    default:
+        finishActive(Status::BusError, _BV(TWSTO));
+        break;
+    }
+}
+
+
+/// Reset the TWI unit and fail the active transaction if it took too long.
+///
+static void checkTimeout()
+{
+    cli();
+    Transaction *transaction = gActive;
+    if (transaction != nullptr) {
+        const uint8_t byteCount = transaction->writeCount + transaction->readCount + 2;
+        const uint32_t timeoutMicros = cTimeoutMarginMicros + static_cast<uint32_t>(byteCount) * gByteMicros;
+        if (micros() - gStartMicros > timeoutMicros) {
+            // Disabling the TWI unit releases SDA and SCL.
+            TWCR = 0;
+            finishActive(Status::Timeout, 0);
+        }
+    }
+    sei();
+}
+
+
+/// Call the callbacks of all finished transactions.
+///
+static void callFinished()
+{
+    while (true) {
+        cli();
+        Transaction *transaction = takeFirstFromList(gFinishedFirst, gFinishedLast);
+        sei();
+        if (transaction == nullptr) {
+            break;
+        }
+        transaction->callback(*transaction);
+    }
+}
+
+
+void begin(uint32_t frequency)
+{
+    // Enable the internal pull-ups of SDA and SCL, like the Wire library.
+    // They keep the bus idle while the unit is disabled after a timeout.
+    digitalWrite(SDA, HIGH);
+    digitalWrite(SCL, HIGH);
+    // The prescaler is 1, so the bit rate is F_CPU / (16 + 2 * TWBR).
+    TWSR = 0;
+    TWBR = static_cast<uint8_t>(((F_CPU / frequency) - 16) / 2);
+    TWCR = _BV(TWEN);
+    // A byte with the acknowledge bit takes 9 clocks, allow twice the time.
+    gByteMicros = static_cast<uint16_t>(18000000ul / frequency);
+}
+
+
+bool submit(Transaction &transaction)
+{
+    if (isPending(transaction)) {
+        return false;
+    }
+    transaction.status = Status::Queued;
+    transaction.failureCount = 0;
+    cli();
+    appendToList(gQueueFirst, gQueueLast, &transaction);
+    if (gActive == nullptr) {
+        startNext(0);
+    }
+    sei();
+    return true;
+}
+
+
+void poll()
+{
+    checkTimeout();
+    callFinished();
+}
+
+
+Status wait(Transaction &transaction)
+{
+    while (isPending(transaction)) {
+        poll();
+    }
+    callFinished();
+    return transaction.status;
+}
+
+
+void flush()
+{
+    while (gActive != nullptr) {
+        poll();
+    }
+    callFinished();
+}
+
+
+Status transfer(uint8_t address, const uint8_t *writeData, uint8_t writeCount, uint8_t *readData, uint8_t readCount)
+{
+    Transaction transaction = {};
+    transaction.address = address;
+    transaction.writeData = writeData;
+    transaction.writeCount = writeCount;
+    transaction.readData = readData;
+    transaction.readCount = readCount;
+    submit(transaction);
+    return wait(transaction);
+}
+
+
+}
+}
+
+
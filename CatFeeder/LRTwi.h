@@ -0,0 +1,152 @@
+#pragma once
+//
+// Lucky Resistor's TWI Driver
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <Arduino.h>
+
+
+namespace lr {
+
+
+/// An interrupt driven driver for the TWI unit of the AVR chips.
+///
+/// Transactions are queued and executed one after the other by the
+/// interrupt of the TWI unit, so the firmware can continue while the bytes
+/// are sent. Each transaction writes bytes to a device, reads bytes from
+/// it, or writes the bytes and reads after a repeated start condition.
+///
+/// A failed transaction is repeated up to `cRetryCount` times. If the
+/// interrupt does not finish a transaction in time, `poll()` resets the
+/// TWI unit and handles it like a failed transaction. This keeps the
+/// latency bounded if a device does not respond or the bus is stuck.
+///
+/// Like the `Wire` library, begin() enables the internal pull-ups of SDA and
+/// SCL. They are weak (20-50kOhm), so a reliable bus at 100kHz and above
+/// still needs external pull-up resistors.
+///
+/// This driver replaces the `Wire` library and can not be used together
+/// with it, because both use the TWI interrupt.
+///
+namespace Twi {
+
+
+/// The number of retries after a failed transaction.
+///
+const uint8_t cRetryCount = 2;
+
+
+/// The status of a transaction.
+///
+enum class Status : uint8_t {
+    Idle, ///< The transaction was never submitted.
+    Queued, ///< The transaction waits in the queue.
+    Active, ///< The transaction is on the bus.
+    Success, ///< The transaction was successful.
+    AddressNack, ///< The device did not acknowledge the address.
+    DataNack, ///< The device did not acknowledge a written byte.
+    ArbitrationLost, ///< Another master took the bus.
+    BusError, ///< There was an illegal start or stop condition.
+    Timeout, ///< The transaction did not finish in time.
+};
+
+
+struct Transaction;
+
+/// The callback for a finished transaction.
+///
+/// Callbacks are called from `poll()` and `wait()`, never from the
+/// interrupt, so they can submit new transactions.
+///
+typedef void (*Callback)(Transaction &transaction);
+
+
+/// A transaction on the bus.
+///
+/// The transaction and its buffers are owned by the caller and have to
+/// stay valid until the transaction is finished.
+///
+struct Transaction {
+    uint8_t address; ///< The 7 bit address of the device.
+    const uint8_t *writeData; ///< The bytes to write, or `nullptr`.
+    uint8_t writeCount; ///< The number of bytes to write.
+    uint8_t *readData; ///< The buffer for the read bytes, or `nullptr`.
+    uint8_t readCount; ///< The number of bytes to read.
+    Callback callback; ///< The callback if the transaction is finished, or `nullptr`.
+    volatile Status status; ///< The status of the transaction.
+    uint8_t failureCount; ///< The number of failed attempts (internal).
+    Transaction *next; ///< The next transaction in the queue (internal).
+};
+
+
+/// Initialize the TWI unit.
+///
+/// @param frequency The clock frequency of the bus.
+///
+void begin(uint32_t frequency = 100000);
+
+/// Submit a transaction to the queue.
+///
+/// @param transaction The transaction to execute.
+/// @return `false` if the transaction is already in the queue.
+///
+bool submit(Transaction &transaction);
+
+/// Check the running transaction for a timeout and call the callbacks.
+///
+/// Call this method regularly from the main loop.
+///
+void poll();
+
+/// Check if a transaction is queued or on the bus.
+///
+inline bool isPending(const Transaction &transaction)
+{
+    return transaction.status == Status::Queued || transaction.status == Status::Active;
+}
+
+/// Wait until a transaction is finished.
+///
+/// @return The final status of the transaction, or `Status::Idle` if
+///    it was never submitted.
+///
+Status wait(Transaction &transaction);
+
+/// Wait until all submitted transactions are finished.
+///
+void flush();
+
+/// Execute a transaction and wait until it is finished.
+///
+/// @param address The 7 bit address of the device.
+/// @param writeData The bytes to write.
+/// @param writeCount The number of bytes to write.
+/// @param readData The buffer for the read bytes.
+/// @param readCount The number of bytes to read.
+/// @return The final status of the transaction.
+///
+Status transfer(uint8_t address, const uint8_t *writeData, uint8_t writeCount,
+    uint8_t *readData = nullptr, uint8_t readCount = 0);
+
+
+}
+}
+
+
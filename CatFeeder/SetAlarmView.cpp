@@ -24,6 +24,7 @@
 #include "Display.h"
 #include "Data.h"
 #include "LRPCF8523.h"
+#include "Trace.h"
 
 
 using namespace lr;
@@ -77,15 +78,17 @@ void SetAlarmView::handleKeyPress(KeyPad::Key key)
     } else if (key == KeyPad::Select) {
         ++_adjustIndex;
         if (_adjustIndex >= 3) {
-            // Adjust the alarm
-            PCF8523::setAlarmMinute(Data::alarmMinute);
-            PCF8523::setAlarmHour(Data::alarmHour);
+            // Adjust the alarm, with all changes in as few writes as possible.
+            PCF8523::StagedWrite changes;
+            changes.setAlarmMinute(Data::alarmMinute);
+            changes.setAlarmHour(Data::alarmHour);
             // Set the alarm mode.
-            PCF8523::setAlarmMode(PCF8523::AlarmMode::HourMinute);
+            changes.setAlarmMode(PCF8523::AlarmMode::HourMinute);
             // Make sure the alarm interrupt is enabled.
-            PCF8523::enableInterrupt(PCF8523::Interrupt::Alarm);
+            changes.enableInterrupt(PCF8523::Interrupt::Alarm);
             // Clear the interrupt flag if it got already set.
-            PCF8523::clearAlarm();
+            changes.clearAlarm();
+            changes.flush();
             // Back to the status view
             Application::switchToState(Application::State::Status);
         }
@@ -98,6 +101,7 @@ void SetAlarmView::handleKeyPress(KeyPad::Key key)
 
 void SetAlarmView::loop()
 {
+    LR_TRACE_SCOPE("SetAlarmView::loop");
     if ((_displayUpdateCounter & 0x1f) == 0) {
         Display::updateSetAlarm(_adjustIndex, ((_displayUpdateCounter & 0x20) == 0));
     }
@@ -21,9 +21,10 @@
 
 
 #include "Application.h"
-#include "LRPCF8523.h"
+#include "Clock.h"
 #include "Display.h"
 #include "Data.h"
+#include "Trace.h"
 
 
 using namespace lr;
@@ -31,6 +32,7 @@ using namespace lr;
 
 void SetTimeView::enter()
 {
+    Data::now = Clock::getDateTime();
     Display::switchToView(Display::View::SetTime);
     _displayUpdateCounter = 0;
     _adjustIndex = 0;
@@ -63,7 +65,7 @@ void SetTimeView::handleKeyPress(KeyPad::Key key)
         ++_adjustIndex;
         if (_adjustIndex >= 6) {
             // Adjust the time
-            PCF8523::setDateTime(Data::now);
+            Clock::setDateTime(Data::now);
             Application::switchToState(Application::State::Status);
         }
         _displayUpdateCounter = 0;
@@ -75,6 +77,7 @@ void SetTimeView::handleKeyPress(KeyPad::Key key)
 
 void SetTimeView::loop()
 {
+    LR_TRACE_SCOPE("SetTimeView::loop");
     if ((_displayUpdateCounter & 0x1f) == 0) {
         Display::updateSetTime(_adjustIndex, ((_displayUpdateCounter & 0x20) == 0));
     }
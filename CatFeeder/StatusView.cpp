@@ -21,10 +21,12 @@
 
 
 #include "Application.h"
+#include "Clock.h"
 #include "LRPCF8523.h"
 #include "Display.h"
 #include "Data.h"
 #include "Hardware.h"
+#include "Trace.h"
 
 
 using namespace lr;
@@ -33,6 +35,7 @@ using namespace lr;
 namespace {
 const uint16_t cDisplayUpdateWithWarning = 25; // Every ~500ms
 const uint16_t cDisplayUpdateNoWarning = 500; // Every 10s
+const uint32_t cNoDisplaySeconds = 0xffffffff; // Forces a display refresh.
 }
 
 
@@ -40,10 +43,13 @@ void StatusView::enter()
 {
     // Reset the (not initialised) display counter.
     _displayUpdateCounter = 0;
+    _displaySeconds = cNoDisplaySeconds;
     _blinkState = false;
     // Read the current alarm time from the RTC.
-    Data::alarmHour = PCF8523::getAlarmHour();
-    Data::alarmMinute = PCF8523::getAlarmMinute();
+    PCF8523::Snapshot rtc;
+    rtc.read(PCF8523::Register::MinuteAlarm, PCF8523::Register::HourAlarm);
+    Data::alarmHour = rtc.getAlarmHour();
+    Data::alarmMinute = rtc.getAlarmMinute();
 }
 
 
@@ -57,23 +63,34 @@ void StatusView::handleKeyPress(KeyPad::Key key)
 
 void StatusView::loop()
 {
+    LR_TRACE_SCOPE("StatusView::loop");
     bool displayRefresh = false;
-    // Check for warnings every ~500ms
-    if ((_displayUpdateCounter & 0x001f) == 0) {
-        // Check for an alarm.
-        if (PCF8523::isAlarm()) {
+    // An alarm holds the interrupt output of the RTC, which is checked
+    // without I2C access. Only then, the alarm flag is read.
+    if (Hardware::checkRtcInterruptHeld()) {
+        PCF8523::Snapshot rtc;
+        rtc.read(PCF8523::Register::Control2, PCF8523::Register::Control2);
+        if (rtc.isAlarm()) {
             // First, clear the alarm.
-            PCF8523::clearAlarm();
+            rtc.clearAlarm();
+            // The active alarm interrupt has hidden the second pulses.
+            Clock::synchronize();
             // Check if the time matches.
-            Data::now = PCF8523::getDateTime();
+            Data::now = Clock::getDateTime();
             if (Data::now.getHour() == Data::alarmHour && Data::now.getMinute() == Data::alarmMinute) {
                 // Switch to the alarm state.
                 Application::switchToState(Application::State::Alarm);
                 return;
-            }            
+            }
         }
+    }
+    // Check for warnings every ~500ms
+    if ((_displayUpdateCounter & 0x001f) == 0) {
+        // Read the battery flag.
+        PCF8523::Snapshot rtc;
+        rtc.read(PCF8523::Register::Control3, PCF8523::Register::Control3);
         // Check the battery levels.
-        if (PCF8523::isBackupBatteryLow()) {
+        if (rtc.isBackupBatteryLow()) {
             Data::warning = Data::Warning::RtcBatteryLow;
         } else if (Hardware::isBatteryLow()) {
             Data::warning = Data::Warning::BatteryLow;
@@ -84,11 +101,15 @@ void StatusView::loop()
             displayRefresh = true;
         }
     }
-    // Update the time from RTC every ~10s
-    if ((_displayUpdateCounter & 0x01ff) == 0) {
-        // Get the current date/time.
-        Data::now = PCF8523::getDateTime();
-        displayRefresh = true;
+    // Update the time from the software clock, this needs no I2C access.
+    const uint32_t seconds = Clock::getSecondsSince2000();
+    if (seconds != _displaySeconds) {
+        Data::now = DateTime::fromSecondsSince2000(seconds);
+        // The display shows no seconds, refresh it for a new minute.
+        if ((seconds / 60) != (_displaySeconds / 60)) {
+            displayRefresh = true;
+        }
+        _displaySeconds = seconds;
     }
     // Refresh the display if necessary.
     if (displayRefresh) {
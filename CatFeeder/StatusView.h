@@ -36,5 +36,6 @@ public: // Implement the View class.
 
 private:
     uint16_t _displayUpdateCounter;
+    uint32_t _displaySeconds;
     bool _blinkState;
 };
\ No newline at end of file
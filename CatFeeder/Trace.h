@@ -0,0 +1,81 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Configuration.h"
+
+#include <Arduino.h>
+
+
+/// Scoped markers to trace where the firmware spends its time.
+///
+/// Place `LR_TRACE_SCOPE("Name")` at the start of a block. The marker
+/// records the begin of the block and, when the block is left, the end.
+/// The markers compile to nothing unless `LR_TRACE_ENABLED` is defined in
+/// `Configuration.h`. On the device, each marker writes a line with the
+/// time in microseconds to the serial port, which is then started at boot.
+/// The host build records the markers on the virtual clock and writes a
+/// Chrome trace, without the serial port.
+///
+namespace Trace {
+
+
+/// Record the begin of a traced block.
+///
+void begin(const __FlashStringHelper *name);
+
+/// Record the end of a traced block.
+///
+void end(const __FlashStringHelper *name);
+
+
+/// A traced block, from the construction to the destruction.
+///
+class Scope
+{
+public:
+    /// Record the begin of the block.
+    ///
+    inline Scope(const __FlashStringHelper *name) : _name(name) { begin(name); }
+
+    /// dtor
+    ///
+    inline ~Scope() { end(_name); }
+
+private:
+    const __FlashStringHelper *_name; ///< The name of the block.
+};
+
+
+}
+
+
+#ifdef LR_TRACE_ENABLED
+#define LR_TRACE_SCOPE(name) Trace::Scope traceScope(F(name))
+#else
+#define LR_TRACE_SCOPE(name)
+#endif
+
+// Defined if the markers are written to the serial port.
+#if defined(LR_TRACE_ENABLED) && defined(ARDUINO_ARCH_AVR)
+#define LR_TRACE_SERIAL 1
+#endif
+
@@ -20,6 +20,9 @@
 #include "View.h"
 
 
+#include "Trace.h"
+
+
 void View::enter()
 {
     // do nothing by default.
@@ -34,5 +37,6 @@ void View::handleKeyPress(KeyPad::Key key)
 
 void View::loop()
 {
+    LR_TRACE_SCOPE("View::loop");
     // do nothing by default.
 }
@@ -0,0 +1,73 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Arduino.h"
+
+
+#include "Board.h"
+
+
+/// The time to read the timer with micros() on the device, in microseconds.
+///
+static const uint32_t cMicrosCallDuration = 4;
+
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    Host::Board::pinMode(pin, mode);
+}
+
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    Host::Board::digitalWrite(pin, value);
+}
+
+
+int digitalRead(uint8_t pin)
+{
+    return Host::Board::digitalRead(pin);
+}
+
+
+unsigned long millis()
+{
+    return static_cast<unsigned long>(Host::Board::getMicrosSinceBoot() / 1000);
+}
+
+
+unsigned long micros()
+{
+    // Let the time of the call pass, so a busy wait for a timeout ends.
+    Host::Board::delayMicroseconds(cMicrosCallDuration);
+    return static_cast<unsigned long>(Host::Board::getMicrosSinceBoot());
+}
+
+
+void delay(unsigned long ms)
+{
+    Host::Board::delayMicroseconds(static_cast<uint32_t>(ms) * 1000);
+}
+
+
+void delayMicroseconds(unsigned int us)
+{
+    Host::Board::delayMicroseconds(us);
+}
+
@@ -0,0 +1,314 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "avr/interrupt.h"
+#include "avr/io.h"
+
+
+#include "Board.h"
+#include "I2cBus.h"
+
+
+extern "C" void TWI_vect();
+extern "C" void PCINT2_vect();
+
+
+namespace Host {
+namespace Avr {
+
+
+/// The state of the simulated TWI unit.
+///
+enum class TwiState : uint8_t {
+    Idle, ///< The bus is free.
+    Address, ///< A start condition was sent, the address is next.
+    Write, ///< The address was sent for a write.
+    Read, ///< The address was sent for a read.
+    Held, ///< The device holds SCL low, no operation can finish.
+};
+
+
+TwiControlRegister gTwcr;
+volatile uint8_t gTwdr = 0xff;
+volatile uint8_t gTwsr = 0xf8;
+volatile uint8_t gTwbr = 0;
+volatile uint8_t gPcicr = 0;
+volatile uint8_t gPcmsk0 = 0;
+volatile uint8_t gPcmsk1 = 0;
+volatile uint8_t gPcmsk2 = 0;
+
+/// The control bits of TWCR, without TWINT.
+///
+static uint8_t gTwiControl = 0;
+
+/// The TWINT flag.
+///
+static bool gIsTwiInterruptFlag = false;
+
+/// The state of the TWI unit.
+///
+static TwiState gTwiState = TwiState::Idle;
+
+/// The address of the current transaction.
+///
+static uint8_t gTwiAddress = 0;
+
+/// If a device acknowledged the address of the current transaction.
+///
+static bool gIsTwiAcknowledged = false;
+
+/// The bytes of the current transaction.
+///
+static uint8_t gTwiBuffer[0x100];
+
+/// The number of bytes in the current transaction.
+///
+static uint8_t gTwiByteCount = 0;
+
+/// If the interrupts are enabled.
+///
+static bool gAreInterruptsEnabled = true;
+
+/// The levels of the port D pins 0-7 at the last check.
+///
+static uint8_t gPortDLevels = 0;
+
+/// The PCIF2 flag.
+///
+static bool gIsPinChangeFlag2 = false;
+
+
+/// Read the levels of the port D pins 0-7.
+///
+static uint8_t readPortD()
+{
+    uint8_t result = 0;
+    for (uint8_t pin = 0; pin < 8; ++pin) {
+        if (Board::digitalRead(pin) != 0) {
+            result |= _BV(pin);
+        }
+    }
+    return result;
+}
+
+
+/// Compare the levels of port D with the last check, and set PCIF2 on a change.
+///
+static void updatePinChangeFlags()
+{
+    const uint8_t levels = readPortD();
+    if (((levels ^ gPortDLevels) & gPcmsk2) != 0) {
+        gIsPinChangeFlag2 = true;
+    }
+    gPortDLevels = levels;
+}
+
+
+/// Call the enabled and requested interrupts, while the interrupts are enabled.
+///
+static void callInterrupts()
+{
+    const uint8_t cTwiEnabled = _BV(TWEN)|_BV(TWIE);
+    while (gAreInterruptsEnabled) {
+        if (gIsTwiInterruptFlag && (gTwiControl & cTwiEnabled) == cTwiEnabled) {
+            gAreInterruptsEnabled = false;
+            TWI_vect();
+            gAreInterruptsEnabled = true;
+        } else if (gIsPinChangeFlag2 && (gPcicr & _BV(PCIE2)) != 0) {
+            // The flag is cleared when the interrupt routine is executed.
+            gIsPinChangeFlag2 = false;
+            gAreInterruptsEnabled = false;
+            PCINT2_vect();
+            gAreInterruptsEnabled = true;
+        } else {
+            break;
+        }
+    }
+}
+
+
+/// Check the inputs for changes, called by the simulated board.
+///
+static void checkPinChanges()
+{
+    updatePinChangeFlags();
+    callInterrupts();
+}
+
+
+/// Connects the pin change interrupts to the board while the firmware is loaded.
+///
+class PinChangeConnection
+{
+public:
+    PinChangeConnection() {
+        gPortDLevels = readPortD();
+        Board::setPinChangeHandler(&checkPinChanges);
+    }
+    ~PinChangeConnection() {
+        Board::setPinChangeHandler(nullptr);
+    }
+};
+
+static PinChangeConnection gPinChangeConnection;
+
+
+/// Set the status of the TWI unit and the TWINT flag.
+///
+static void setTwiStatus(uint8_t status)
+{
+    gTwsr = status | (gTwsr & 0x03);
+    gIsTwiInterruptFlag = true;
+}
+
+
+/// Get the bus frequency for the values in TWBR and TWSR.
+///
+static uint32_t getTwiFrequency()
+{
+    static const uint8_t cPrescaler[] = {1, 4, 16, 64};
+    return F_CPU / (16ul + 2ul * gTwbr * cPrescaler[gTwsr & 0x03]);
+}
+
+
+/// End the current transaction on the simulated bus.
+///
+/// Written bytes are passed to the device at the end of the transaction.
+/// Read bytes were already taken from the device one by one. A write can
+/// change an interrupt output of the device, so the inputs are checked.
+/// A transaction to a device which holds the clock is counted as aborted.
+///
+static void endTwiTransaction(bool sendStop)
+{
+    if (gTwiState == TwiState::Held) {
+        I2cBus::recordAbort();
+    } else if (gTwiState == TwiState::Write || gTwiState == TwiState::Read) {
+        const bool isRead = (gTwiState == TwiState::Read);
+        I2cBus::record(gTwiAddress, isRead, gTwiByteCount, sendStop, gIsTwiAcknowledged);
+        I2cDevice *device = I2cBus::getDevice(gTwiAddress);
+        if (!isRead && device != nullptr && gTwiByteCount > 0) {
+            device->i2cWrite(gTwiBuffer, gTwiByteCount);
+            updatePinChangeFlags();
+        }
+    }
+    gTwiState = TwiState::Idle;
+}
+
+
+/// Execute the operation after TWINT was written.
+///
+static void executeTwiOperation(uint8_t control)
+{
+    if (gTwiState == TwiState::Held) {
+        return; // Only disabling the unit releases the bus.
+    }
+    if ((control & _BV(TWSTO)) != 0) {
+        endTwiTransaction(true);
+        gTwiControl &= ~_BV(TWSTO); // Cleared by the unit after the stop condition.
+    }
+    if ((control & _BV(TWSTA)) != 0) {
+        const bool isRepeated = (gTwiState != TwiState::Idle);
+        endTwiTransaction(false);
+        I2cBus::setClock(getTwiFrequency());
+        gTwiState = TwiState::Address;
+        setTwiStatus(isRepeated ? 0x10 : 0x08);
+        return;
+    }
+    switch (gTwiState) {
+    case TwiState::Idle:
+    case TwiState::Held:
+        break;
+    case TwiState::Address: {
+        gTwiAddress = gTwdr >> 1;
+        gTwiByteCount = 0;
+        if (I2cBus::getFault(gTwiAddress) == I2cBus::Fault::HoldClock) {
+            gTwiState = TwiState::Held;
+            break;
+        }
+        gIsTwiAcknowledged = (I2cBus::getDevice(gTwiAddress) != nullptr);
+        const bool isRead = (gTwdr & 0x01) != 0;
+        gTwiState = isRead ? TwiState::Read : TwiState::Write;
+        if (isRead) {
+            setTwiStatus(gIsTwiAcknowledged ? 0x40 : 0x48);
+        } else {
+            setTwiStatus(gIsTwiAcknowledged ? 0x18 : 0x20);
+        }
+        break;
+    }
+    case TwiState::Write:
+        if (gIsTwiAcknowledged) {
+            gTwiBuffer[gTwiByteCount++] = gTwdr;
+            setTwiStatus(0x28);
+        } else {
+            setTwiStatus(0x30);
+        }
+        break;
+    case TwiState::Read: {
+        uint8_t data = 0xff;
+        I2cDevice *device = I2cBus::getDevice(gTwiAddress);
+        if (device != nullptr) {
+            device->i2cRead(&data, 1);
+        }
+        gTwdr = data;
+        ++gTwiByteCount;
+        setTwiStatus(((control & _BV(TWEA)) != 0) ? 0x50 : 0x58);
+        break;
+    }
+    }
+}
+
+
+TwiControlRegister& TwiControlRegister::operator=(uint8_t value)
+{
+    gTwiControl = value & ~_BV(TWINT);
+    if ((value & _BV(TWEN)) == 0) {
+        // Disabling the unit releases the bus immediately.
+        endTwiTransaction(false);
+        gIsTwiInterruptFlag = false;
+    } else if ((value & _BV(TWINT)) != 0) {
+        gIsTwiInterruptFlag = false;
+        executeTwiOperation(value);
+    }
+    callInterrupts();
+    return *this;
+}
+
+
+TwiControlRegister::operator uint8_t() const
+{
+    return gTwiControl | (gIsTwiInterruptFlag ? _BV(TWINT) : 0);
+}
+
+
+}
+}
+
+
+void cli()
+{
+    Host::Avr::gAreInterruptsEnabled = false;
+}
+
+
+void sei()
+{
+    Host::Avr::gAreInterruptsEnabled = true;
+    Host::Avr::callInterrupts();
+}
+
@@ -0,0 +1,44 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Host stand-in for the `main.cpp` of the Arduino core.
+//
+// The firmware image is a shared module which is loaded for every simulated
+// power cycle. These unmangled entry points are looked up by the loader in
+// `Host/Simulation/Firmware.cpp`.
+
+
+// The sketch entry points.
+void setup();
+void loop();
+
+
+extern "C" void catFeederSetup()
+{
+    setup();
+}
+
+
+extern "C" void catFeederLoop()
+{
+    loop();
+}
+
@@ -0,0 +1,222 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Print.h"
+
+
+#include <stdio.h>
+#include <string.h>
+
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t count = 0;
+    while (size--) {
+        if (write(*buffer++)) {
+            ++count;
+        } else {
+            break;
+        }
+    }
+    return count;
+}
+
+
+size_t Print::write(const char *str)
+{
+    if (str == nullptr) {
+        return 0;
+    }
+    return write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+}
+
+
+size_t Print::print(const __FlashStringHelper *text)
+{
+    // Like the original, program memory strings are written character by character.
+    const char *p = reinterpret_cast<const char*>(text);
+    size_t count = 0;
+    while (true) {
+        const char c = pgm_read_byte(p++);
+        if (c == '\0') {
+            break;
+        }
+        count += write(static_cast<uint8_t>(c));
+    }
+    return count;
+}
+
+
+size_t Print::print(const String &text)
+{
+    return write(reinterpret_cast<const uint8_t*>(text.c_str()), text.length());
+}
+
+
+size_t Print::print(const char text[])
+{
+    return write(text);
+}
+
+
+size_t Print::print(char c)
+{
+    return write(static_cast<uint8_t>(c));
+}
+
+
+size_t Print::print(unsigned char value, int base)
+{
+    return print(static_cast<unsigned long>(value), base);
+}
+
+
+size_t Print::print(int value, int base)
+{
+    return print(static_cast<long>(value), base);
+}
+
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print(static_cast<unsigned long>(value), base);
+}
+
+
+size_t Print::print(long value, int base)
+{
+    if (base == 0) {
+        return write(static_cast<uint8_t>(value));
+    } else if (base == 10 && value < 0) {
+        const size_t count = print('-');
+        return count + printNumber(static_cast<unsigned long>(-value), 10);
+    }
+    return printNumber(static_cast<unsigned long>(value), base);
+}
+
+
+size_t Print::print(unsigned long value, int base)
+{
+    if (base == 0) {
+        return write(static_cast<uint8_t>(value));
+    }
+    return printNumber(value, base);
+}
+
+
+size_t Print::print(double value, int digits)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return write(buffer);
+}
+
+
+size_t Print::println(const __FlashStringHelper *text)
+{
+    const size_t count = print(text);
+    return count + println();
+}
+
+
+size_t Print::println(const String &text)
+{
+    const size_t count = print(text);
+    return count + println();
+}
+
+
+size_t Print::println(const char text[])
+{
+    const size_t count = print(text);
+    return count + println();
+}
+
+
+size_t Print::println(char c)
+{
+    const size_t count = print(c);
+    return count + println();
+}
+
+
+size_t Print::println(unsigned char value, int base)
+{
+    const size_t count = print(value, base);
+    return count + println();
+}
+
+
+size_t Print::println(int value, int base)
+{
+    const size_t count = print(value, base);
+    return count + println();
+}
+
+
+size_t Print::println(unsigned int value, int base)
+{
+    const size_t count = print(value, base);
+    return count + println();
+}
+
+
+size_t Print::println(long value, int base)
+{
+    const size_t count = print(value, base);
+    return count + println();
+}
+
+
+size_t Print::println(unsigned long value, int base)
+{
+    const size_t count = print(value, base);
+    return count + println();
+}
+
+
+size_t Print::println(double value, int digits)
+{
+    const size_t count = print(value, digits);
+    return count + println();
+}
+
+
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+
+size_t Print::printNumber(unsigned long value, uint8_t base)
+{
+    char buffer[8 * sizeof(long) + 1];
+    char *str = &buffer[sizeof(buffer) - 1];
+    *str = '\0';
+    if (base < 2) {
+        base = 10;
+    }
+    do {
+        const char digit = value % base;
+        value /= base;
+        *--str = digit < 10 ? digit + '0' : digit + 'A' - 10;
+    } while (value);
+    return write(str);
+}
+
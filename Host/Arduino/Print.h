@@ -0,0 +1,76 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "WString.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+
+/// Host stand-in for the Arduino `Print` class.
+///
+/// All methods are implemented like in the Arduino core, so a print
+/// call generates the same sequence of `write()` calls as on the device.
+///
+class Print
+{
+public:
+    virtual ~Print() = default;
+
+public:
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str);
+
+    size_t print(const __FlashStringHelper *text);
+    size_t print(const String &text);
+    size_t print(const char text[]);
+    size_t print(char c);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println(const __FlashStringHelper *text);
+    size_t println(const String &text);
+    size_t println(const char text[]);
+    size_t println(char c);
+    size_t println(unsigned char value, int base = DEC);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(double value, int digits = 2);
+    size_t println();
+
+private:
+    size_t printNumber(unsigned long value, uint8_t base);
+};
+
@@ -0,0 +1,97 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Servo.h"
+
+
+/// The pulse width for 0 degrees.
+///
+static const int cMinPulseWidth = 544;
+
+/// The pulse width for 180 degrees.
+///
+static const int cMaxPulseWidth = 2400;
+
+/// The initial pulse width after attach.
+///
+static const int cDefaultPulseWidth = 1500;
+
+
+Servo::Servo()
+    : _pin(-1), _pulseWidth(cDefaultPulseWidth)
+{
+}
+
+
+uint8_t Servo::attach(int pin)
+{
+    _pin = static_cast<int8_t>(pin);
+    return 0;
+}
+
+
+void Servo::detach()
+{
+    _pin = -1;
+}
+
+
+void Servo::write(int value)
+{
+    // Like the original, values below the minimum pulse width are angles.
+    if (value < cMinPulseWidth) {
+        if (value < 0) {
+            value = 0;
+        } else if (value > 180) {
+            value = 180;
+        }
+        value = cMinPulseWidth + (value * (cMaxPulseWidth - cMinPulseWidth)) / 180;
+    }
+    writeMicroseconds(value);
+}
+
+
+void Servo::writeMicroseconds(int value)
+{
+    if (value < cMinPulseWidth) {
+        value = cMinPulseWidth;
+    } else if (value > cMaxPulseWidth) {
+        value = cMaxPulseWidth;
+    }
+    _pulseWidth = static_cast<uint16_t>(value);
+}
+
+
+int Servo::read()
+{
+    return ((_pulseWidth - cMinPulseWidth) * 180 + (cMaxPulseWidth - cMinPulseWidth) / 2) / (cMaxPulseWidth - cMinPulseWidth);
+}
+
+
+int Servo::readMicroseconds()
+{
+    return _pulseWidth;
+}
+
+
+bool Servo::attached()
+{
+    return _pin >= 0;
+}
+
@@ -0,0 +1,49 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Host implementation of the trace markers in `CatFeeder/Trace.h`.
+//
+// The markers are forwarded to the trace of the simulation, which records
+// them on the virtual clock.
+
+
+#include "Trace.h"
+
+#include "TraceLog.h"
+
+
+namespace Trace {
+
+
+void begin(const __FlashStringHelper *name)
+{
+    Host::TraceLog::begin(reinterpret_cast<const char*>(name));
+}
+
+
+void end(const __FlashStringHelper *name)
+{
+    Host::TraceLog::end(reinterpret_cast<const char*>(name));
+}
+
+
+}
+
@@ -0,0 +1,82 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "WString.h"
+
+
+#include <stdlib.h>
+#include <string.h>
+
+
+String::String(const char *text)
+    : _buffer(nullptr), _length(strlen(text))
+{
+    _buffer = static_cast<char*>(malloc(_length + 1));
+    memcpy(_buffer, text, _length + 1);
+}
+
+
+String::String(const String &other)
+    : String(other.c_str())
+{
+}
+
+
+String::~String()
+{
+    free(_buffer);
+}
+
+
+String& String::operator=(const String &other)
+{
+    if (this != &other) {
+        char *buffer = static_cast<char*>(malloc(other._length + 1));
+        memcpy(buffer, other._buffer, other._length + 1);
+        free(_buffer);
+        _buffer = buffer;
+        _length = other._length;
+    }
+    return *this;
+}
+
+
+bool String::operator==(const String &other) const
+{
+    return _length == other._length && memcmp(_buffer, other._buffer, _length) == 0;
+}
+
+
+bool String::operator!=(const String &other) const
+{
+    return !operator==(other);
+}
+
+
+const char* String::c_str() const
+{
+    return _buffer;
+}
+
+
+unsigned int String::length() const
+{
+    return _length;
+}
+
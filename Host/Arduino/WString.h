@@ -0,0 +1,59 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <avr/pgmspace.h>
+
+#include <stddef.h>
+
+
+/// Marker type for strings in program memory.
+///
+class __FlashStringHelper;
+
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(PSTR(string_literal)))
+
+
+/// Host stand-in for the Arduino `String` class.
+///
+/// Like the original, every instance owns a heap allocated buffer.
+///
+class String
+{
+public:
+    String(const char *text = "");
+    String(const String &other);
+    ~String();
+
+public:
+    String& operator=(const String &other);
+    bool operator==(const String &other) const;
+    bool operator!=(const String &other) const;
+
+public:
+    const char* c_str() const;
+    unsigned int length() const;
+
+private:
+    char *_buffer; ///< The zero terminated string.
+    unsigned int _length; ///< The length of the string.
+};
+
@@ -0,0 +1,40 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Host stand-in for the AVR interrupt handling.
+//
+// An interrupt routine is a plain function, which is called by the
+// simulated peripheral. While the interrupts are disabled, the calls are
+// delayed until `sei()`.
+
+
+#define ISR(vector) extern "C" void vector()
+
+
+/// Disable the interrupts.
+///
+void cli();
+
+/// Enable the interrupts and call the pending interrupt routines.
+///
+void sei();
+
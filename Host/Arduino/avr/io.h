@@ -0,0 +1,113 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Host stand-in for the AVR register definitions.
+//
+// Only the registers of the TWI unit and the pin change interrupts are
+// provided. They are connected to a simulated TWI unit in
+// `Host/Arduino/Avr.cpp`, which executes the bus operations on the
+// simulated I2C bus and calls the TWI interrupt. The pin change interrupt
+// of port D is called when the simulated board reports a changed input.
+
+
+#include <stdint.h>
+
+
+#ifndef _BV
+#define _BV(bit) (1 << (bit))
+#endif
+
+#ifndef F_CPU
+#define F_CPU 16000000UL // Like the Arduino Uno.
+#endif
+
+
+namespace Host {
+namespace Avr {
+
+
+/// The TWCR register of the simulated TWI unit.
+///
+/// Writing a value with the TWINT bit set starts the next operation of
+/// the unit: a start condition, the address, a data byte or the stop
+/// condition. The operations are executed immediately. If the interrupt
+/// is enabled, the TWI interrupt is called after each operation.
+///
+class TwiControlRegister
+{
+public:
+    TwiControlRegister& operator=(uint8_t value);
+    operator uint8_t() const;
+};
+
+
+extern TwiControlRegister gTwcr;
+extern volatile uint8_t gTwdr;
+extern volatile uint8_t gTwsr;
+extern volatile uint8_t gTwbr;
+extern volatile uint8_t gPcicr;
+extern volatile uint8_t gPcmsk0;
+extern volatile uint8_t gPcmsk1;
+extern volatile uint8_t gPcmsk2;
+
+
+}
+}
+
+
+#define TWCR (Host::Avr::gTwcr)
+#define TWDR (Host::Avr::gTwdr)
+#define TWSR (Host::Avr::gTwsr)
+#define TWBR (Host::Avr::gTwbr)
+#define PCICR (Host::Avr::gPcicr)
+#define PCMSK0 (Host::Avr::gPcmsk0)
+#define PCMSK1 (Host::Avr::gPcmsk1)
+#define PCMSK2 (Host::Avr::gPcmsk2)
+
+// The bits of TWCR.
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+
+// The bits of TWSR.
+#define TWPS1 1
+#define TWPS0 0
+
+// The bits of PCICR.
+#define PCIE2 2
+#define PCIE1 1
+#define PCIE0 0
+
+// The bits of PCMSK2, the pins 0-7 of port D.
+#define PCINT23 7
+#define PCINT22 6
+#define PCINT21 5
+#define PCINT20 4
+#define PCINT19 3
+#define PCINT18 2
+#define PCINT17 1
+#define PCINT16 0
+
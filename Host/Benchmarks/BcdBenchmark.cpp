@@ -0,0 +1,224 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Micro benchmarks for the BCD codec of the firmware.
+//
+// Usage: catfeeder_benchmark_bcd [--baseline <file>] [--write-baseline <file>]
+//
+// --baseline <file>        Compare with this baseline (default: the checked-in
+//                          `Host/Benchmarks/Bcd.baseline`).
+// --write-baseline <file>  Write the results as new baseline.
+//
+// Each conversion runs twice: byte by byte with a mask per field, like the
+// RTC driver did it before, and with the block conversion of `LRBcd.h`.
+// The inputs are the seven time registers of the PCF8523, with random flag
+// bits outside of the value masks.
+//
+// The block conversion is the same code as on AVR, a loop with a constant
+// mask per byte. The benchmark guards it against regressions compared to
+// the unrolled conversion per field.
+
+
+#include "Benchmark.h"
+
+#include "LRBcd.h"
+
+#include <cstdio>
+#include <vector>
+
+
+namespace Bcd = lr::Bcd;
+using Host::Benchmark::getRandom;
+
+
+/// The number of inputs per benchmark.
+///
+static const uint32_t cInputCount = 4096;
+
+/// The number of time registers.
+///
+static const uint8_t cTimeCount = 7;
+
+/// The value masks of the time registers, like the RTC driver uses them.
+///
+static const uint8_t cTimeValueMasks[cTimeCount] = {0x7f, 0x7f, 0x3f, 0x3f, 0x07, 0x1f, 0xff};
+
+/// The largest value of each time register.
+///
+static const uint8_t cTimeMaximum[cTimeCount] = {59, 59, 23, 31, 6, 12, 99};
+
+
+/// A block of registers.
+///
+struct Block {
+    uint8_t bytes[8]; ///< The register values.
+};
+
+
+/// The inputs for the benchmarks.
+///
+struct Inputs {
+    std::vector<Block> timeRegisters; ///< The time registers in BCD format, with flags.
+    std::vector<Block> timeValues; ///< Binary values for the time registers.
+};
+
+
+/// Create random register and value blocks.
+///
+static void createBlocks(const uint8_t *maximum, uint8_t count, const uint8_t *valueMasks,
+    std::vector<Block> &registers, std::vector<Block> &values)
+{
+    Block registerBlock = {};
+    Block valueBlock = {};
+    for (uint8_t i = 0; i < count; ++i) {
+        const uint8_t flags = static_cast<uint8_t>(getRandom()) & ~valueMasks[i];
+        registerBlock.bytes[i] = Bcd::encode(getRandom() % (maximum[i] + 1)) | flags;
+        valueBlock.bytes[i] = getRandom() % (maximum[i] + 1);
+    }
+    registers.push_back(registerBlock);
+    values.push_back(valueBlock);
+}
+
+
+/// Create the inputs for all benchmarks.
+///
+static Inputs createInputs()
+{
+    Inputs inputs;
+    for (uint32_t i = 0; i < cInputCount; ++i) {
+        createBlocks(cTimeMaximum, cTimeCount, cTimeValueMasks, inputs.timeRegisters, inputs.timeValues);
+    }
+    return inputs;
+}
+
+
+/// Get a value which depends on all bytes of a block.
+///
+static uint32_t getByteSum(const uint8_t *bytes, uint8_t count)
+{
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        sum += bytes[i];
+    }
+    return sum;
+}
+
+
+/// Decode the time registers byte by byte.
+///
+static uint32_t decodeTimeByBytes(const Block &block)
+{
+    const uint8_t *data = block.bytes;
+    uint8_t values[cTimeCount];
+    values[0] = Bcd::decode(data[0]&0x7f);
+    values[1] = Bcd::decode(data[1]&0x7f);
+    values[2] = Bcd::decode(data[2]&0x3f);
+    values[3] = Bcd::decode(data[3]&0x3f);
+    values[4] = data[4]&0x7;
+    values[5] = Bcd::decode(data[5]&0x1f);
+    values[6] = Bcd::decode(data[6]);
+    return getByteSum(values, cTimeCount);
+}
+
+
+/// Encode the time registers byte by byte.
+///
+static uint32_t encodeTimeByBytes(const Block &block)
+{
+    const uint8_t *values = block.bytes;
+    uint8_t data[cTimeCount];
+    data[0] = Bcd::encode(values[0]);
+    data[1] = Bcd::encode(values[1]);
+    data[2] = Bcd::encode(values[2]);
+    data[3] = Bcd::encode(values[3]);
+    data[4] = values[4];
+    data[5] = Bcd::encode(values[5]);
+    data[6] = Bcd::encode(values[6]);
+    return getByteSum(data, cTimeCount);
+}
+
+
+/// Convert a block with the block conversion.
+///
+template<uint8_t tCount>
+static uint32_t decodeBlock(const Block &block, const uint8_t *valueMasks)
+{
+    uint8_t values[tCount];
+    Bcd::decodeBlock(block.bytes, values, tCount, valueMasks);
+    return getByteSum(values, tCount);
+}
+
+
+/// Convert a block with the block conversion.
+///
+template<uint8_t tCount>
+static uint32_t encodeBlock(const Block &block)
+{
+    uint8_t data[tCount];
+    Bcd::encodeBlock(block.bytes, data, tCount);
+    return getByteSum(data, tCount);
+}
+
+
+/// Check if both paths convert all inputs the same way.
+///
+static bool verify(const Inputs &inputs)
+{
+    for (uint32_t i = 0; i < cInputCount; ++i) {
+        if (decodeTimeByBytes(inputs.timeRegisters[i]) != decodeBlock<cTimeCount>(inputs.timeRegisters[i], cTimeValueMasks)
+            || encodeTimeByBytes(inputs.timeValues[i]) != encodeBlock<cTimeCount>(inputs.timeValues[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/// Run all benchmarks.
+///
+static bool runBenchmarks()
+{
+    using Host::Benchmark::measure;
+    const Inputs inputs = createInputs();
+    if (!verify(inputs)) {
+        fprintf(stderr, "The block conversion differs from the conversion byte by byte.\n");
+        return false;
+    }
+    measure("decodeTime(bytes)", cInputCount, [&](uint32_t i) {
+        return decodeTimeByBytes(inputs.timeRegisters[i]);
+    });
+    measure("decodeTime(block)", cInputCount, [&](uint32_t i) {
+        return decodeBlock<cTimeCount>(inputs.timeRegisters[i], cTimeValueMasks);
+    });
+    measure("encodeTime(bytes)", cInputCount, [&](uint32_t i) {
+        return encodeTimeByBytes(inputs.timeValues[i]);
+    });
+    measure("encodeTime(block)", cInputCount, [&](uint32_t i) {
+        return encodeBlock<cTimeCount>(inputs.timeValues[i]);
+    });
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    return Host::Benchmark::main(argc, argv, CATFEEDER_BCD_BASELINE, runBenchmarks);
+}
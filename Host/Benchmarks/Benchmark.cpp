@@ -0,0 +1,158 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Benchmark.h"
+
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+
+namespace Host {
+namespace Benchmark {
+
+
+/// One recorded result.
+///
+struct Result {
+    std::string name; ///< The name of the benchmark.
+    double nanosPerOperation; ///< The measured time.
+};
+
+
+/// The sink for all consumed values.
+///
+static volatile uint32_t gSink = 0;
+
+/// The recorded results in the order of the measurement.
+///
+static std::vector<Result> gResults;
+
+/// The baseline values.
+///
+static std::map<std::string, double> gBaseline;
+
+
+uint32_t getRandom()
+{
+    static uint32_t state = 0x2017cafe;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+void consume(uint32_t value)
+{
+    gSink = gSink + value;
+}
+
+
+void record(const std::string &name, double nanosPerOperation)
+{
+    Result result;
+    result.name = name;
+    result.nanosPerOperation = nanosPerOperation;
+    gResults.push_back(result);
+}
+
+
+bool readBaseline(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        return false;
+    }
+    gBaseline.clear();
+    char line[256];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        char name[128];
+        double nanos;
+        if (line[0] != '#' && sscanf(line, "%127s %lf", name, &nanos) == 2) {
+            gBaseline[name] = nanos;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+
+bool writeBaseline(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "# Benchmark baseline in nanoseconds per operation.\n");
+    for (const auto &result : gResults) {
+        fprintf(file, "%s %.2f\n", result.name.c_str(), result.nanosPerOperation);
+    }
+    fclose(file);
+    return true;
+}
+
+
+void printReport(FILE *file)
+{
+    fprintf(file, "%-32s %10s %10s %9s\n", "Benchmark", "ns/op", "baseline", "speedup");
+    for (const auto &result : gResults) {
+        fprintf(file, "%-32s %10.2f", result.name.c_str(), result.nanosPerOperation);
+        const auto baseline = gBaseline.find(result.name);
+        if (baseline != gBaseline.end() && result.nanosPerOperation > 0.0) {
+            fprintf(file, " %10.2f %8.2fx\n", baseline->second, baseline->second / result.nanosPerOperation);
+        } else {
+            fprintf(file, " %10s %9s\n", "-", "-");
+        }
+    }
+}
+
+int main(int argc, char *argv[], const char *baselinePath, Cases cases)
+{
+    const char *newBaselinePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc) {
+            newBaselinePath = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--baseline <file>] [--write-baseline <file>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!readBaseline(baselinePath)) {
+        fprintf(stderr, "No baseline in %s\n", baselinePath);
+    }
+
+    if (!cases()) {
+        return 1;
+    }
+
+    printReport(stdout);
+    if (newBaselinePath != nullptr && !writeBaseline(newBaselinePath)) {
+        perror(newBaselinePath);
+        return 1;
+    }
+    return 0;
+}
+
+
+}
+}
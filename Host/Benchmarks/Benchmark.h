@@ -0,0 +1,148 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <chrono>
+#include <string>
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+namespace Host {
+
+
+/// A minimal runner for micro benchmarks on the host.
+///
+/// Each benchmark executes an operation for a fixed set of inputs. The
+/// set is repeated until the measurement takes long enough, and the best
+/// of several rounds is reported in nanoseconds per operation. The results
+/// are compared against a baseline file, which has one `<name> <ns/op>`
+/// pair per line. Lines starting with `#` are comments.
+///
+/// The absolute values depend on the computer and compiler. Compare them
+/// only against a baseline written on the same machine.
+///
+namespace Benchmark {
+
+
+/// The minimum time of one measurement round in microseconds.
+///
+const uint32_t cMinimumRoundMicros = 50000;
+
+/// The number of measurement rounds.
+///
+const uint8_t cRoundCount = 5;
+
+
+/// The benchmark cases of one program.
+///
+/// Creates the inputs and measures all operations.
+///
+/// @return `false` if the cases could not be run, after printing an error.
+///
+typedef bool (*Cases)();
+
+
+/// A simple and reproducible pseudo random number generator (xorshift32).
+///
+/// Every program starts with the same state, so all runs use the same inputs.
+///
+uint32_t getRandom();
+
+/// Keep a result alive, so the compiler can not remove the operation.
+///
+void consume(uint32_t value);
+
+/// Record the result of a benchmark.
+///
+/// @param name The name of the benchmark, without spaces.
+/// @param nanosPerOperation The measured time per operation.
+///
+void record(const std::string &name, double nanosPerOperation);
+
+/// Measure an operation.
+///
+/// @param name The name of the benchmark, without spaces.
+/// @param inputCount The number of inputs for the operation.
+/// @param operation The operation, called with the input index and
+///    returning a value which depends on the result.
+///
+template<typename Operation>
+void measure(const std::string &name, uint32_t inputCount, Operation operation)
+{
+    typedef std::chrono::steady_clock Clock;
+    double bestNanos = 0.0;
+    for (uint8_t round = 0; round < cRoundCount; ++round) {
+        uint64_t operationCount = 0;
+        uint32_t result = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        do {
+            for (uint32_t i = 0; i < inputCount; ++i) {
+                result += operation(i);
+            }
+            operationCount += inputCount;
+            elapsed = Clock::now() - start;
+        } while (std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() < cMinimumRoundMicros);
+        consume(result);
+        const double nanos = std::chrono::duration<double, std::nano>(elapsed).count() / operationCount;
+        if (round == 0 || nanos < bestNanos) {
+            bestNanos = nanos;
+        }
+    }
+    record(name, bestNanos);
+}
+
+/// Read a baseline file.
+///
+/// @return `true` on success.
+///
+bool readBaseline(const char *path);
+
+/// Write the recorded results as baseline file.
+///
+/// @return `true` on success.
+///
+bool writeBaseline(const char *path);
+
+/// Print the recorded results and the comparison with the baseline.
+///
+void printReport(FILE *file);
+
+/// The main entry point of a benchmark program.
+///
+/// Parses the command line, runs the cases and prints the report.
+///
+/// Usage: <program> [--baseline <file>] [--write-baseline <file>]
+///
+/// @param argc The argument count from `main()`.
+/// @param argv The arguments from `main()`.
+/// @param baselinePath The default baseline, used without `--baseline`.
+/// @param cases The benchmark cases.
+/// @return The exit code for `main()`.
+///
+int main(int argc, char *argv[], const char *baselinePath, Cases cases);
+
+
+}
+}
+
@@ -0,0 +1,178 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Micro benchmarks for the `DateTime` class of the firmware.
+//
+// Usage: catfeeder_benchmark_datetime [--baseline <file>] [--write-baseline <file>]
+//
+// --baseline <file>        Compare with this baseline (default: the checked-in
+//                          `Host/Benchmarks/DateTime.baseline`).
+// --write-baseline <file>  Write the results as new baseline.
+//
+// All operations use the same inputs, spread over the full supported range
+// from 2000-01-01 00:00:00 to 2136-02-07 06:28:15.
+
+
+#include "Benchmark.h"
+
+#include "LRDateTime.h"
+
+#include <vector>
+
+
+using lr::DateTime;
+using Host::Benchmark::getRandom;
+
+
+/// The number of inputs per benchmark.
+///
+static const uint32_t cInputCount = 4096;
+
+/// The largest offset for the add and difference benchmarks, in seconds.
+///
+static const int32_t cMaximumOffset = 0x40000000;
+
+/// The number of seconds per day.
+///
+static const int32_t cSecondsPerDay = 86400;
+
+
+/// The inputs for the benchmarks.
+///
+struct Inputs {
+    std::vector<uint32_t> seconds; ///< Seconds since 2000 over the full range.
+    std::vector<DateTime> dateTimes; ///< The date/time for each value in `seconds`.
+    std::vector<int32_t> offsets; ///< An offset in seconds which keeps the sum in range.
+    std::vector<int32_t> dayOffsets; ///< An offset in days which keeps the sum in range.
+    std::vector<DateTime> offsetDateTimes; ///< The date/time plus the offset.
+    std::vector<DateTime> nearDateTimes; ///< An equal or close date/time, for the comparisons.
+};
+
+
+/// Get an offset for the given seconds which keeps the sum in the 32bit range.
+///
+static int32_t getOffset(uint32_t seconds, int32_t maximum)
+{
+    int32_t offset = static_cast<int32_t>(getRandom() % (2 * static_cast<uint32_t>(maximum))) - maximum;
+    if ((offset > 0 && seconds > UINT32_MAX - static_cast<uint32_t>(offset))
+        || (offset < 0 && seconds < static_cast<uint32_t>(-offset))) {
+        offset = -offset;
+    }
+    return offset;
+}
+
+
+/// Create the inputs for all benchmarks.
+///
+static Inputs createInputs()
+{
+    Inputs inputs;
+    for (uint32_t i = 0; i < cInputCount; ++i) {
+        const uint32_t seconds = getRandom();
+        const DateTime dateTime = DateTime::fromSecondsSince2000(seconds);
+        const int32_t offset = getOffset(seconds, cMaximumOffset);
+        const int32_t dayOffset = getOffset(seconds, cMaximumOffset / cSecondsPerDay * cSecondsPerDay) / cSecondsPerDay;
+        inputs.seconds.push_back(seconds);
+        inputs.dateTimes.push_back(dateTime);
+        inputs.offsets.push_back(offset);
+        inputs.dayOffsets.push_back(dayOffset);
+        inputs.offsetDateTimes.push_back(DateTime::fromSecondsSince2000(seconds + offset));
+        // Every fourth value is equal, the others differ by up to two days.
+        if ((i & 3) == 0) {
+            inputs.nearDateTimes.push_back(dateTime);
+        } else {
+            inputs.nearDateTimes.push_back(dateTime.addSeconds(getOffset(seconds, 2 * cSecondsPerDay)));
+        }
+    }
+    return inputs;
+}
+
+
+/// Get a value which depends on all fields of a date/time.
+///
+static uint32_t getFieldSum(const DateTime &dateTime)
+{
+    return dateTime.getYear() + dateTime.getMonth() + dateTime.getDay()
+        + dateTime.getHour() + dateTime.getMinute() + dateTime.getSecond();
+}
+
+
+/// Run all benchmarks.
+///
+static bool runBenchmarks()
+{
+    using Host::Benchmark::measure;
+    const Inputs inputs = createInputs();
+    measure("toSecondsSince2000", cInputCount, [&](uint32_t i) {
+        return inputs.dateTimes[i].toSecondsSince2000();
+    });
+    measure("fromSecondsSince2000", cInputCount, [&](uint32_t i) {
+        return getFieldSum(DateTime::fromSecondsSince2000(inputs.seconds[i]));
+    });
+    measure("addSeconds", cInputCount, [&](uint32_t i) {
+        return getFieldSum(inputs.dateTimes[i].addSeconds(inputs.offsets[i]));
+    });
+    measure("addDays", cInputCount, [&](uint32_t i) {
+        return getFieldSum(inputs.dateTimes[i].addDays(inputs.dayOffsets[i]));
+    });
+    measure("secondsTo", cInputCount, [&](uint32_t i) {
+        return static_cast<uint32_t>(inputs.dateTimes[i].secondsTo(inputs.offsetDateTimes[i]));
+    });
+    measure("operator==", cInputCount, [&](uint32_t i) {
+        return static_cast<uint32_t>(inputs.dateTimes[i] == inputs.nearDateTimes[i]);
+    });
+    measure("operator!=", cInputCount, [&](uint32_t i) {
+        return static_cast<uint32_t>(inputs.dateTimes[i] != inputs.nearDateTimes[i]);
+    });
+    measure("operator<", cInputCount, [&](uint32_t i) {
+        return static_cast<uint32_t>(inputs.dateTimes[i] < inputs.nearDateTimes[i]);
+    });
+    measure("operator<=", cInputCount, [&](uint32_t i) {
+        return static_cast<uint32_t>(inputs.dateTimes[i] <= inputs.nearDateTimes[i]);
+    });
+    measure("operator>", cInputCount, [&](uint32_t i) {
+        return static_cast<uint32_t>(inputs.dateTimes[i] > inputs.nearDateTimes[i]);
+    });
+    measure("operator>=", cInputCount, [&](uint32_t i) {
+        return static_cast<uint32_t>(inputs.dateTimes[i] >= inputs.nearDateTimes[i]);
+    });
+    measure("toString(Long)", cInputCount, [&](uint32_t i) {
+        return inputs.dateTimes[i].toString(DateTime::Format::Long).length();
+    });
+    measure("toString(ShortTime)", cInputCount, [&](uint32_t i) {
+        return inputs.dateTimes[i].toString(DateTime::Format::ShortTime).length();
+    });
+    measure("toBuffer(Long)", cInputCount, [&](uint32_t i) {
+        char buffer[DateTime::cMaximumFormatLength + 1];
+        return static_cast<uint32_t>(inputs.dateTimes[i].toBuffer(buffer, DateTime::Format::Long)[18]);
+    });
+    measure("toBuffer(ShortTime)", cInputCount, [&](uint32_t i) {
+        char buffer[DateTime::cMaximumFormatLength + 1];
+        return static_cast<uint32_t>(inputs.dateTimes[i].toBuffer(buffer, DateTime::Format::ShortTime)[4]);
+    });
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    return Host::Benchmark::main(argc, argv, CATFEEDER_DATETIME_BASELINE, runBenchmarks);
+}
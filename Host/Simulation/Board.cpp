@@ -0,0 +1,254 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Board.h"
+
+
+#include "I2cBus.h"
+#include "VirtualTime.h"
+
+#include <Arduino.h>
+
+
+namespace Host {
+namespace Board {
+
+
+/// The mode of all pins.
+///
+static uint8_t gPinMode[cPinCount];
+
+/// The output level of all pins.
+///
+static uint8_t gPinOutput[cPinCount];
+
+/// The position of the programming mode switch.
+///
+static bool gProgrammingMode = false;
+
+/// The state of the battery low signal.
+///
+static bool gBatteryLow = false;
+
+/// The file for the serial output.
+///
+static FILE *gSerialOutput = stdout;
+
+/// The baud rate of the serial port, zero if not started.
+///
+static uint32_t gSerialBaudRate = 0;
+
+/// The size of the transmit buffer of the Arduino serial driver.
+///
+static const uint8_t cSerialBufferSize = 64;
+
+/// The virtual time when the serial port has sent all buffered bytes.
+///
+static uint64_t gSerialIdleMicros = 0;
+
+/// The virtual time of the last power on.
+///
+static uint64_t gBootMicros = 0;
+
+/// The real time clock.
+///
+static Pcf8523 gRtc;
+
+/// The LCD shield.
+///
+static RgbLcdShield gLcdShield;
+
+/// The handler for changes of the inputs.
+///
+static PinChangeHandler gPinChangeHandler = nullptr;
+
+
+/// Get the virtual time of the next possible change of an input.
+///
+/// Only the interrupt output of the RTC changes without an action of the
+/// firmware.
+///
+static uint64_t getNextInputChangeMicros()
+{
+    if (gPinChangeHandler == nullptr) {
+        return VirtualTime::cNoEvent;
+    }
+    return gRtc.getNextInterruptChangeMicros();
+}
+
+
+/// Pass a possible change of an input to the handler.
+///
+static void handleInputChange()
+{
+    if (gPinChangeHandler != nullptr) {
+        gPinChangeHandler();
+    }
+}
+
+
+void powerOn()
+{
+    for (uint8_t pin = 0; pin < cPinCount; ++pin) {
+        gPinMode[pin] = INPUT;
+        gPinOutput[pin] = LOW;
+    }
+    gSerialBaudRate = 0;
+    gSerialIdleMicros = 0;
+    gBootMicros = VirtualTime::getMicros();
+    gLcdShield.powerOnReset();
+    I2cBus::attach(Pcf8523::cAddress, &gRtc);
+    I2cBus::attach(RgbLcdShield::cAddress, &gLcdShield);
+    VirtualTime::setEventSource(&getNextInputChangeMicros, &handleInputChange);
+}
+
+
+Pcf8523& getRtc()
+{
+    return gRtc;
+}
+
+
+RgbLcdShield& getLcdShield()
+{
+    return gLcdShield;
+}
+
+
+void setProgrammingMode(bool enabled)
+{
+    gProgrammingMode = enabled;
+}
+
+
+void setBatteryLow(bool enabled)
+{
+    gBatteryLow = enabled;
+}
+
+
+bool isServoPowered()
+{
+    // The MOSFET is pulled up, so the servo has only power if the pin is driven low.
+    return gPinMode[cServoPowerPin] == OUTPUT && gPinOutput[cServoPowerPin] == LOW;
+}
+
+
+void setSerialOutput(FILE *file)
+{
+    gSerialOutput = file;
+}
+
+
+uint64_t getMicrosSinceBoot()
+{
+    return VirtualTime::getMicros() - gBootMicros;
+}
+
+
+void setPinChangeHandler(PinChangeHandler handler)
+{
+    gPinChangeHandler = handler;
+}
+
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < cPinCount) {
+        gPinMode[pin] = mode;
+    }
+}
+
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin >= cPinCount) {
+        return;
+    }
+    const uint8_t level = (value != LOW) ? HIGH : LOW;
+    const bool isRisingEdge = (gPinOutput[pin] == LOW && level == HIGH);
+    gPinOutput[pin] = level;
+    // A rising edge on the done pin makes the TPL5110 cut the power.
+    if (pin == cDonePin && gPinMode[pin] == OUTPUT && isRisingEdge) {
+        throw PowerOff();
+    }
+}
+
+
+int digitalRead(uint8_t pin)
+{
+    if (pin >= cPinCount) {
+        return LOW;
+    }
+    if (gPinMode[pin] == OUTPUT) {
+        return gPinOutput[pin];
+    }
+    switch (pin) {
+    case cProgrammingModePin:
+        // The switch connects the pin to GND in programming mode.
+        return gProgrammingMode ? LOW : (gPinMode[pin] == INPUT_PULLUP ? HIGH : LOW);
+    case cBatteryLowPin:
+        return gBatteryLow ? HIGH : LOW;
+    case cRtcInterruptPin:
+        return gRtc.isInterruptActive() ? HIGH : LOW;
+    default:
+        return (gPinMode[pin] == INPUT_PULLUP) ? HIGH : LOW;
+    }
+}
+
+
+void delayMicroseconds(uint32_t us)
+{
+    VirtualTime::advance(us);
+}
+
+
+void serialBegin(uint32_t baud)
+{
+    gSerialBaudRate = baud;
+    gSerialIdleMicros = VirtualTime::getMicros();
+}
+
+
+void serialWrite(uint8_t value)
+{
+    if (gSerialBaudRate == 0) {
+        return;
+    }
+    // Each byte takes ten bits on the line. The driver only blocks while
+    // its transmit buffer is full.
+    const uint64_t byteMicros = (10000000ull + gSerialBaudRate - 1) / gSerialBaudRate;
+    const uint64_t now = VirtualTime::getMicros();
+    if (gSerialIdleMicros < now) {
+        gSerialIdleMicros = now;
+    }
+    const uint64_t bufferMicros = cSerialBufferSize * byteMicros;
+    if (gSerialIdleMicros - now > bufferMicros) {
+        VirtualTime::advance(gSerialIdleMicros - now - bufferMicros);
+    }
+    gSerialIdleMicros += byteMicros;
+    if (gSerialOutput != nullptr && value != '\r') {
+        fputc(value, gSerialOutput);
+    }
+}
+
+
+}
+}
+
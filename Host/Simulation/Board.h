@@ -0,0 +1,154 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Pcf8523.h"
+#include "RgbLcdShield.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+/// The host simulation of the cat feeder hardware.
+///
+namespace Host {
+
+
+/// Thrown if the TPL5110 cuts the power of the device.
+///
+/// This is the only way the firmware "returns" from `Hardware::sendDoneSignal()`.
+///
+struct PowerOff {
+};
+
+
+/// The simulated Arduino board with the wiring of the cat feeder.
+///
+/// The pin numbers match the connections documented in `CatFeeder.ino`.
+///
+namespace Board {
+
+
+/// The pin which controls the servo power.
+///
+const uint8_t cServoPowerPin = 2;
+
+/// The pin connected to the programming mode switch.
+///
+const uint8_t cProgrammingModePin = 3;
+
+/// The pin with the done signal to the TPL5110.
+///
+const uint8_t cDonePin = 4;
+
+/// The pin with the low battery signal.
+///
+const uint8_t cBatteryLowPin = 5;
+
+/// The pin with the interrupt output of the RTC.
+///
+/// The BSS84 level shifter drives the pin high while INT1 is active.
+///
+const uint8_t cRtcInterruptPin = 7;
+
+/// The pin with the servo control output.
+///
+const uint8_t cServoPin = 9;
+
+/// The number of digital pins of the board.
+///
+const uint8_t cPinCount = 20;
+
+
+/// A function which is called when an input may have changed.
+///
+typedef void (*PinChangeHandler)();
+
+
+/// Simulate a power on of the device.
+///
+/// This resets all pins, attaches the devices to the I2C bus and restarts
+/// the time since boot at the current virtual time.
+///
+void powerOn();
+
+/// Get the real time clock on the data logging shield.
+///
+/// The clock is battery backed and keeps its state between power cycles.
+///
+Pcf8523& getRtc();
+
+/// Get the RGB LCD shield.
+///
+/// The shield has no own power supply, so it is reset at every power on.
+///
+RgbLcdShield& getLcdShield();
+
+/// Set the position of the programming mode switch.
+///
+void setProgrammingMode(bool enabled);
+
+/// Set the state of the low battery signal.
+///
+void setBatteryLow(bool enabled);
+
+/// Check if the servo has power.
+///
+bool isServoPowered();
+
+/// Redirect the serial output of the firmware.
+///
+/// The serial port is simulated with the transmit buffer of the Arduino
+/// driver. A write blocks the firmware while the buffer is full, also if
+/// the output is discarded.
+///
+/// @param file The file for the output, `nullptr` to discard it. The
+///    default is `stdout`.
+///
+void setSerialOutput(FILE *file);
+
+/// Get the number of microseconds since the last power on.
+///
+uint64_t getMicrosSinceBoot();
+
+/// Set the handler for changes of the inputs.
+///
+/// The firmware stand-in for the pin change interrupts sets the handler
+/// while it is loaded. The handler is called at each time an input may
+/// change, and has to compare the levels itself.
+///
+/// @param handler The handler, or `nullptr` to remove it.
+///
+void setPinChangeHandler(PinChangeHandler handler);
+
+
+// Implementation of the Arduino API.
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void delayMicroseconds(uint32_t us);
+void serialBegin(uint32_t baud);
+void serialWrite(uint8_t value);
+
+
+}
+}
+
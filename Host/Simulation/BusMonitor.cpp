@@ -0,0 +1,264 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "BusMonitor.h"
+
+
+#include "CallStack.h"
+#include "I2cBus.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace Host {
+namespace BusMonitor {
+
+
+/// The number of possible 7 bit addresses.
+///
+static const uint8_t cAddressCount = 0x80;
+
+
+/// The accumulated values for one firmware function.
+///
+struct FunctionTotals {
+    Totals totals; ///< All transactions while the function was on the stack.
+    std::map<uint8_t, Totals> deviceTotals; ///< The transactions per address.
+    uint32_t callCount; ///< The number of bursts.
+};
+
+
+/// Flag if the attribution is enabled.
+///
+static bool gAttributionEnabled = false;
+
+/// The file for the transaction log.
+///
+static FILE *gLogFile = nullptr;
+
+/// The totals for the current power cycle.
+///
+static Totals gCycleTotals = {};
+
+/// The totals since the start.
+///
+static Totals gTotals = {};
+
+/// The totals per device for the current power cycle.
+///
+static Totals gCycleDeviceTotals[cAddressCount] = {};
+
+/// The totals per device since the start.
+///
+static Totals gDeviceTotals[cAddressCount] = {};
+
+/// The totals per firmware function.
+///
+static std::map<std::string, FunctionTotals> gFunctionTotals;
+
+/// The functions on the stack for the previous transaction.
+///
+static std::set<std::string> gPreviousFunctions;
+
+
+/// Add a transaction to the totals.
+///
+static void addTransaction(Totals &totals, const Transaction &transaction)
+{
+    ++totals.transactionCount;
+    totals.byteCount += transaction.byteCount;
+    totals.nanos100kHz += I2cBus::getTransactionNanos(transaction.byteCount, transaction.isStop, 100000);
+    totals.nanos400kHz += I2cBus::getTransactionNanos(transaction.byteCount, transaction.isStop, 400000);
+}
+
+
+/// Join the path into one string.
+///
+static std::string joinPath(const std::vector<std::string> &path)
+{
+    std::string result;
+    for (const auto &name : path) {
+        if (!result.empty()) {
+            result += " > ";
+        }
+        result += name;
+    }
+    return result;
+}
+
+
+/// Add a transaction to all functions on the path.
+///
+static void attributeTransaction(const Transaction &transaction, const std::vector<std::string> &path)
+{
+    std::set<std::string> functions(path.begin(), path.end());
+    for (const auto &name : functions) {
+        auto &entry = gFunctionTotals[name];
+        addTransaction(entry.totals, transaction);
+        addTransaction(entry.deviceTotals[transaction.address], transaction);
+        if (gPreviousFunctions.count(name) == 0) {
+            ++entry.callCount;
+        }
+    }
+    gPreviousFunctions.swap(functions);
+}
+
+
+void setAttributionEnabled(bool enabled)
+{
+    gAttributionEnabled = enabled;
+}
+
+
+void setLogFile(FILE *file)
+{
+    gLogFile = file;
+    if (gLogFile != nullptr) {
+        fprintf(gLogFile, "start_us,address,direction,bytes,stop,ack,path\n");
+    }
+}
+
+
+void beginCycle()
+{
+    gCycleTotals = Totals();
+    for (auto &totals : gCycleDeviceTotals) {
+        totals = Totals();
+    }
+    gPreviousFunctions.clear();
+}
+
+
+void record(const Transaction &transaction)
+{
+    addTransaction(gCycleTotals, transaction);
+    addTransaction(gTotals, transaction);
+    addTransaction(gCycleDeviceTotals[transaction.address % cAddressCount], transaction);
+    addTransaction(gDeviceTotals[transaction.address % cAddressCount], transaction);
+    std::vector<std::string> path;
+    if (gAttributionEnabled) {
+        path = CallStack::getFirmwarePath();
+        attributeTransaction(transaction, path);
+    }
+    if (gLogFile != nullptr) {
+        fprintf(gLogFile, "%llu,0x%02x,%c,%u,%u,%u,\"%s\"\n",
+            static_cast<unsigned long long>(transaction.startMicros),
+            transaction.address,
+            transaction.isRead ? 'R' : 'W',
+            transaction.byteCount,
+            transaction.isStop ? 1 : 0,
+            transaction.isAcknowledged ? 1 : 0,
+            joinPath(path).c_str());
+    }
+}
+
+
+const Totals& getCycleTotals()
+{
+    return gCycleTotals;
+}
+
+
+const Totals& getCycleTotals(uint8_t address)
+{
+    return gCycleDeviceTotals[address % cAddressCount];
+}
+
+
+const Totals& getTotals()
+{
+    return gTotals;
+}
+
+
+const Totals& getTotals(uint8_t address)
+{
+    return gDeviceTotals[address % cAddressCount];
+}
+
+
+/// Print the report for the given totals of each function.
+///
+static void printReport(FILE *file, const char *title, const std::vector<std::pair<std::string, const FunctionTotals*>> &functions,
+    const std::function<const Totals*(const FunctionTotals&)> &selectTotals)
+{
+    std::vector<std::pair<std::string, const FunctionTotals*>> entries;
+    for (const auto &function : functions) {
+        if (selectTotals(*function.second) != nullptr) {
+            entries.push_back(function);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [&selectTotals](const std::pair<std::string, const FunctionTotals*> &a, const std::pair<std::string, const FunctionTotals*> &b) {
+        return selectTotals(*a.second)->nanos100kHz > selectTotals(*b.second)->nanos100kHz;
+    });
+    fprintf(file, "%-40s %8s %8s %8s %11s %11s %11s\n",
+        title, "calls", "trans.", "bytes", "ms@100kHz", "ms@400kHz", "ms/call");
+    for (const auto &entry : entries) {
+        const Totals &totals = *selectTotals(*entry.second);
+        const uint32_t callCount = entry.second->callCount;
+        fprintf(file, "%-40s %8u %8u %8u %11.3f %11.3f %11.3f\n",
+            entry.first.c_str(),
+            callCount,
+            totals.transactionCount,
+            totals.byteCount,
+            totals.nanos100kHz / 1000000.0,
+            totals.nanos400kHz / 1000000.0,
+            (callCount > 0) ? (totals.nanos100kHz / 1000000.0 / callCount) : 0.0);
+    }
+}
+
+
+/// Get all functions with their totals.
+///
+static std::vector<std::pair<std::string, const FunctionTotals*>> getFunctions()
+{
+    std::vector<std::pair<std::string, const FunctionTotals*>> functions;
+    for (const auto &entry : gFunctionTotals) {
+        functions.emplace_back(entry.first, &entry.second);
+    }
+    return functions;
+}
+
+
+void printReport(FILE *file)
+{
+    printReport(file, "I2C traffic per function", getFunctions(), [](const FunctionTotals &function) {
+        return &function.totals;
+    });
+}
+
+
+void printReport(FILE *file, uint8_t address)
+{
+    char title[41];
+    snprintf(title, sizeof(title), "I2C traffic to 0x%02x per function", address);
+    printReport(file, title, getFunctions(), [address](const FunctionTotals &function) -> const Totals* {
+        const auto it = function.deviceTotals.find(address);
+        return (it != function.deviceTotals.end()) ? &it->second : nullptr;
+    });
+}
+
+
+}
+}
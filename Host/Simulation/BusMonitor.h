@@ -0,0 +1,121 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+namespace Host {
+
+
+/// Accounting for all transactions on the simulated I2C bus.
+///
+/// Each transaction can be attributed to the firmware functions on the
+/// call stack. The attribution walks the stack for every transaction,
+/// therefore it is disabled by default.
+///
+namespace BusMonitor {
+
+
+/// One transaction on the bus, from the start to the stop or repeated start.
+///
+struct Transaction {
+    uint64_t startMicros; ///< The virtual time of the start condition.
+    uint8_t address; ///< The 7 bit address.
+    bool isRead; ///< `true` for a read, `false` for a write.
+    uint8_t byteCount; ///< The number of data bytes after the address.
+    bool isStop; ///< If the transaction ended with a stop condition.
+    bool isAcknowledged; ///< If a device acknowledged the address.
+};
+
+
+/// Accumulated values for a number of transactions.
+///
+struct Totals {
+    uint32_t transactionCount; ///< The number of transactions.
+    uint32_t byteCount; ///< The number of data bytes, without the address bytes.
+    uint64_t nanos100kHz; ///< The estimated bus time at 100kHz.
+    uint64_t nanos400kHz; ///< The estimated bus time at 400kHz.
+};
+
+
+/// Enable the attribution of transactions to the firmware functions.
+///
+void setAttributionEnabled(bool enabled);
+
+/// Write every transaction as CSV line into the given file.
+///
+/// @param file The file for the log, `nullptr` to disable the log.
+///
+void setLogFile(FILE *file);
+
+/// Start a new power cycle.
+///
+/// This resets the totals for the cycle.
+///
+void beginCycle();
+
+/// Record a transaction.
+///
+void record(const Transaction &transaction);
+
+/// Get the totals for the current power cycle.
+///
+const Totals& getCycleTotals();
+
+/// Get the totals for one device in the current power cycle.
+///
+/// @param address The 7 bit address of the device.
+///
+const Totals& getCycleTotals(uint8_t address);
+
+/// Get the totals since the start of the simulation.
+///
+const Totals& getTotals();
+
+/// Get the totals for one device since the start of the simulation.
+///
+/// @param address The 7 bit address of the device.
+///
+const Totals& getTotals(uint8_t address);
+
+/// Print the totals per firmware function.
+///
+/// Each function accumulates all transactions which were executed while it
+/// was on the call stack. A call counts as one burst of transactions
+/// without other traffic in between. Requires the attribution.
+///
+void printReport(FILE *file);
+
+/// Print the totals per firmware function for one device.
+///
+/// Only functions with transactions to this device are listed.
+///
+/// @param file The file for the report.
+/// @param address The 7 bit address of the device.
+///
+void printReport(FILE *file, uint8_t address);
+
+
+}
+}
+
@@ -0,0 +1,123 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "CallStack.h"
+
+
+#include "Firmware.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unordered_map>
+
+
+namespace Host {
+namespace CallStack {
+
+
+/// The maximum number of stack frames to inspect.
+///
+static const int cMaximumFrames = 48;
+
+/// Prefixes of functions which are part of the libraries, not the firmware.
+///
+static const char* const cLibraryPrefixes[] = {
+    "lr::Twi::",
+    "lr::RgbLcdShield::",
+    "Host::Avr::",
+    "TWI_vect",
+    "sei",
+    "Print::",
+    "HardwareSerial::",
+    "String::",
+    "catFeeder",
+    "setup",
+    "loop",
+};
+
+/// A cache for the demangled function names.
+///
+static std::unordered_map<std::string, std::string> gNameCache;
+
+
+/// Get the readable name of a function, without the parameter list.
+///
+static const std::string& getFunctionName(const char *symbol)
+{
+    auto it = gNameCache.find(symbol);
+    if (it != gNameCache.end()) {
+        return it->second;
+    }
+    std::string name = symbol;
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);
+    if (status == 0 && demangled != nullptr) {
+        name = demangled;
+        const auto parameterStart = name.find('(');
+        if (parameterStart != std::string::npos) {
+            name.erase(parameterStart);
+        }
+    }
+    free(demangled);
+    return gNameCache.emplace(symbol, name).first->second;
+}
+
+
+/// Check if a function belongs to the libraries.
+///
+static bool isLibraryFunction(const std::string &name)
+{
+    for (const char *prefix : cLibraryPrefixes) {
+        if (name.compare(0, strlen(prefix), prefix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+std::vector<std::string> getFirmwarePath()
+{
+    std::vector<std::string> path;
+    void *frames[cMaximumFrames];
+    const int frameCount = backtrace(frames, cMaximumFrames);
+    const void *imageBase = Firmware::getImageBase();
+    for (int i = frameCount - 1; i >= 0; --i) {
+        // Use the call instruction, not the return address.
+        const void *address = static_cast<const char*>(frames[i]) - 1;
+        Dl_info info;
+        if (dladdr(address, &info) == 0 || info.dli_fbase != imageBase || info.dli_sname == nullptr) {
+            continue;
+        }
+        const std::string &name = getFunctionName(info.dli_sname);
+        if (!isLibraryFunction(name)) {
+            path.push_back(name);
+        }
+    }
+    return path;
+}
+
+
+}
+}
+
@@ -0,0 +1,49 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <string>
+#include <vector>
+
+
+namespace Host {
+
+
+/// Access to the firmware functions on the call stack.
+///
+/// The stack is walked with `backtrace()`. Only functions in the loaded
+/// firmware image are returned, without the functions of the Arduino
+/// libraries and the entry points. The names are demangled and without
+/// the parameter list.
+///
+namespace CallStack {
+
+
+/// Get the firmware functions on the current call stack.
+///
+/// @return The function names, starting with the outermost one.
+///
+std::vector<std::string> getFirmwarePath();
+
+
+}
+}
+
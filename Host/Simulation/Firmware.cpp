@@ -0,0 +1,177 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Firmware.h"
+
+
+#include "Board.h"
+#include "BusMonitor.h"
+#include "TraceLog.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+namespace Host {
+namespace Firmware {
+
+
+/// The type of the firmware entry points.
+///
+typedef void (*EntryPoint)();
+
+/// The path to the firmware module.
+///
+static const char *gImagePath = CATFEEDER_FIRMWARE_PATH;
+
+/// The name of a power cycle in the trace.
+///
+static const char *cPowerCycleName = "Power Cycle";
+
+/// The loaded image.
+///
+static void *gImage = nullptr;
+
+/// The base address of the loaded image.
+///
+static const void *gImageBase = nullptr;
+
+/// The loop entry point of the loaded image.
+///
+static EntryPoint gLoopEntry = nullptr;
+
+/// The number of loop() calls since the power on.
+///
+static uint32_t gLoopCount = 0;
+
+/// Flag if the firmware is running.
+///
+static bool gIsRunning = false;
+
+
+/// Resolve an entry point or stop the simulation.
+///
+static EntryPoint getEntryPoint(void *image, const char *name)
+{
+    void *symbol = dlsym(image, name);
+    if (symbol == nullptr) {
+        fprintf(stderr, "Missing entry point %s in the firmware: %s\n", name, dlerror());
+        exit(1);
+    }
+    return reinterpret_cast<EntryPoint>(symbol);
+}
+
+
+void setImagePath(const char *path)
+{
+    gImagePath = path;
+}
+
+
+PowerCycle run(uint32_t maximumLoops)
+{
+    if (powerOn()) {
+        while (gLoopCount < maximumLoops && loop()) {
+        }
+    }
+    return powerOff();
+}
+
+
+bool powerOn()
+{
+    if (gImage != nullptr) {
+        powerOff();
+    }
+    Board::powerOn();
+    // Load a fresh image, this initialises all global variables.
+    gImage = dlopen(gImagePath, RTLD_NOW | RTLD_LOCAL);
+    if (gImage == nullptr) {
+        fprintf(stderr, "Could not load the firmware: %s\n", dlerror());
+        exit(1);
+    }
+    const EntryPoint setupEntry = getEntryPoint(gImage, "catFeederSetup");
+    gLoopEntry = getEntryPoint(gImage, "catFeederLoop");
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(setupEntry), &info) != 0) {
+        gImageBase = info.dli_fbase;
+    }
+    BusMonitor::beginCycle();
+    TraceLog::begin(cPowerCycleName);
+    gLoopCount = 0;
+    gIsRunning = true;
+    try {
+        setupEntry();
+    } catch (const PowerOff&) {
+        gIsRunning = false;
+    }
+    return gIsRunning;
+}
+
+
+bool loop()
+{
+    if (!gIsRunning) {
+        return false;
+    }
+    try {
+        gLoopEntry();
+        ++gLoopCount;
+    } catch (const PowerOff&) {
+        gIsRunning = false;
+    }
+    return gIsRunning;
+}
+
+
+bool isRunning()
+{
+    return gIsRunning;
+}
+
+
+PowerCycle powerOff()
+{
+    PowerCycle result = {0, 0, false};
+    if (gImage == nullptr) {
+        return result;
+    }
+    result.awakeMicros = Board::getMicrosSinceBoot();
+    result.loopCount = gLoopCount;
+    result.isPoweredOff = !gIsRunning;
+    gIsRunning = false;
+    TraceLog::end(cPowerCycleName);
+    gImageBase = nullptr;
+    gLoopEntry = nullptr;
+    dlclose(gImage);
+    gImage = nullptr;
+    return result;
+}
+
+
+const void* getImageBase()
+{
+    return gImageBase;
+}
+
+
+}
+}
+
@@ -0,0 +1,95 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <stdint.h>
+
+
+namespace Host {
+
+
+/// The firmware image running on the simulated board.
+///
+/// The firmware is built as a shared module. It is loaded fresh for every
+/// power cycle, so all global variables start with their initial values,
+/// like the RAM of the microcontroller after a power on. The simulated
+/// hardware lives in the host program and keeps its state.
+///
+namespace Firmware {
+
+
+/// The result of one power cycle.
+///
+struct PowerCycle {
+    uint64_t awakeMicros; ///< The virtual time from power on until the end.
+    uint32_t loopCount; ///< The number of executed loop() calls.
+    bool isPoweredOff; ///< If the firmware sent the done signal.
+};
+
+
+/// Set the path to the firmware module.
+///
+/// The default is the module built together with the host tools.
+///
+void setImagePath(const char *path);
+
+/// Power on the board and run the firmware.
+///
+/// This calls setup() and then loop() until the done signal cuts the
+/// power, or until the given number of loop() calls was executed.
+///
+/// @param maximumLoops The maximum number of loop() calls.
+/// @return The result of the power cycle.
+///
+PowerCycle run(uint32_t maximumLoops);
+
+/// Power on the board, load the firmware and call setup().
+///
+/// @return `true` if the firmware is still running after setup().
+///
+bool powerOn();
+
+/// Call loop() once.
+///
+/// @return `true` if the firmware is still running.
+///
+bool loop();
+
+/// Check if the firmware is running.
+///
+bool isRunning();
+
+/// Cut the power and unload the firmware.
+///
+/// @return The result of the power cycle.
+///
+PowerCycle powerOff();
+
+/// Get the base address of the loaded firmware image.
+///
+/// @return The base address, or `nullptr` if no image is loaded.
+///
+const void* getImageBase();
+
+
+}
+}
+
@@ -0,0 +1,270 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Hd44780.h"
+
+
+namespace Host {
+
+
+/// The number of characters per line in the two line mode.
+///
+static const uint8_t cLineLength = 40;
+
+/// The address of the second line.
+///
+static const uint8_t cSecondLineAddress = 0x40;
+
+/// The size of the display memory in the one line mode.
+///
+static const uint8_t cDisplayMemorySize = 80;
+
+/// The size of the character memory.
+///
+static const uint8_t cCharacterMemorySize = 64;
+
+/// The superscript digits used to print custom characters.
+///
+static const char* const cCustomCharacterSymbols[] = {
+    "⁰", "¹", "²", "³", "⁴", "⁵", "⁶", "⁷"
+};
+
+
+Hd44780::Hd44780()
+{
+    powerOnReset();
+}
+
+
+void Hd44780::powerOnReset()
+{
+    for (uint8_t i = 0; i < cDisplayMemorySize; ++i) {
+        _displayMemory[i] = ' ';
+    }
+    for (uint8_t i = 0; i < cCharacterMemorySize; ++i) {
+        _characterMemory[i] = 0;
+    }
+    _address = 0;
+    _isCharacterAddress = false;
+    _isIncrement = true;
+    _isShiftOnWrite = false;
+    _isDisplayOn = false;
+    _isCursorOn = false;
+    _isBlinkOn = false;
+    _isFourBitMode = false;
+    _isTwoLineMode = false;
+    _displayShift = 0;
+    _isEnabled = false;
+    _hasHighNibble = false;
+    _highNibble = 0;
+    _instructionCount = 0;
+    _dataWriteCount = 0;
+}
+
+
+void Hd44780::setPins(bool rs, bool rw, bool enable, uint8_t data)
+{
+    const bool isFallingEdge = (_isEnabled && !enable);
+    _isEnabled = enable;
+    if (!isFallingEdge || rw) {
+        return;
+    }
+    data &= 0x0f;
+    if (!_isFourBitMode) {
+        execute(rs, data << 4);
+    } else if (!_hasHighNibble) {
+        _highNibble = data;
+        _hasHighNibble = true;
+    } else {
+        _hasHighNibble = false;
+        execute(rs, (_highNibble << 4) | data);
+    }
+}
+
+
+uint8_t Hd44780::getCharacter(uint8_t row, uint8_t column) const
+{
+    if (row >= cRowCount || column >= cColumnCount) {
+        return ' ';
+    }
+    if (_isTwoLineMode) {
+        const uint8_t offset = (column + _displayShift) % cLineLength;
+        return _displayMemory[row * cLineLength + offset];
+    }
+    if (row > 0) {
+        return ' ';
+    }
+    return _displayMemory[(column + _displayShift) % cDisplayMemorySize];
+}
+
+
+const uint8_t* Hd44780::getCustomCharacter(uint8_t index) const
+{
+    return &_characterMemory[(index % cCustomCharacterCount) * 8];
+}
+
+
+bool Hd44780::isDisplayOn() const
+{
+    return _isDisplayOn;
+}
+
+
+uint32_t Hd44780::getInstructionCount() const
+{
+    return _instructionCount;
+}
+
+
+uint32_t Hd44780::getDataWriteCount() const
+{
+    return _dataWriteCount;
+}
+
+
+void Hd44780::print(FILE *file) const
+{
+    fprintf(file, "+----------------+%s\n", _isDisplayOn ? "" : " (off)");
+    for (uint8_t row = 0; row < cRowCount; ++row) {
+        fputc('|', file);
+        for (uint8_t column = 0; column < cColumnCount; ++column) {
+            const uint8_t character = getCharacter(row, column);
+            if (character < 0x10) {
+                fputs(cCustomCharacterSymbols[character % cCustomCharacterCount], file);
+            } else if (character >= 0x20 && character < 0x7f) {
+                fputc(character, file);
+            } else {
+                fputc('?', file);
+            }
+        }
+        fputs("|\n", file);
+    }
+    fputs("+----------------+\n", file);
+}
+
+
+void Hd44780::execute(bool isData, uint8_t value)
+{
+    if (isData) {
+        writeData(value);
+        return;
+    }
+    ++_instructionCount;
+    if ((value & 0x80) != 0) { // Set DDRAM address.
+        _address = value & 0x7f;
+        _isCharacterAddress = false;
+    } else if ((value & 0x40) != 0) { // Set CGRAM address.
+        _address = value & 0x3f;
+        _isCharacterAddress = true;
+    } else if ((value & 0x20) != 0) { // Function set.
+        _isFourBitMode = ((value & 0x10) == 0);
+        _isTwoLineMode = ((value & 0x08) != 0);
+    } else if ((value & 0x10) != 0) { // Cursor or display shift.
+        const bool isRight = ((value & 0x04) != 0);
+        if ((value & 0x08) != 0) {
+            _displayShift = (_displayShift + (isRight ? cLineLength - 1 : 1)) % cLineLength;
+        } else {
+            const bool isIncrement = _isIncrement;
+            _isIncrement = isRight;
+            moveAddress();
+            _isIncrement = isIncrement;
+        }
+    } else if ((value & 0x08) != 0) { // Display on/off control.
+        _isDisplayOn = ((value & 0x04) != 0);
+        _isCursorOn = ((value & 0x02) != 0);
+        _isBlinkOn = ((value & 0x01) != 0);
+    } else if ((value & 0x04) != 0) { // Entry mode set.
+        _isIncrement = ((value & 0x02) != 0);
+        _isShiftOnWrite = ((value & 0x01) != 0);
+    } else if ((value & 0x02) != 0) { // Return home.
+        _address = 0;
+        _isCharacterAddress = false;
+        _displayShift = 0;
+    } else if ((value & 0x01) != 0) { // Clear display.
+        for (uint8_t i = 0; i < cDisplayMemorySize; ++i) {
+            _displayMemory[i] = ' ';
+        }
+        _address = 0;
+        _isCharacterAddress = false;
+        _isIncrement = true;
+        _displayShift = 0;
+    }
+}
+
+
+void Hd44780::writeData(uint8_t value)
+{
+    ++_dataWriteCount;
+    if (_isCharacterAddress) {
+        _characterMemory[_address % cCharacterMemorySize] = value & 0x1f;
+    } else {
+        _displayMemory[getDisplayIndex(_address)] = value;
+        if (_isShiftOnWrite) {
+            _displayShift = (_displayShift + (_isIncrement ? 1 : cLineLength - 1)) % cLineLength;
+        }
+    }
+    moveAddress();
+}
+
+
+void Hd44780::moveAddress()
+{
+    if (_isCharacterAddress) {
+        _address = (_address + (_isIncrement ? 1 : cCharacterMemorySize - 1)) % cCharacterMemorySize;
+        return;
+    }
+    if (!_isTwoLineMode) {
+        _address = (_address + (_isIncrement ? 1 : cDisplayMemorySize - 1)) % cDisplayMemorySize;
+        return;
+    }
+    // In the two line mode, the end of one line continues on the other line.
+    if (_isIncrement) {
+        if (_address == cLineLength - 1) {
+            _address = cSecondLineAddress;
+        } else if (_address == cSecondLineAddress + cLineLength - 1) {
+            _address = 0;
+        } else {
+            ++_address;
+        }
+    } else {
+        if (_address == cSecondLineAddress) {
+            _address = cLineLength - 1;
+        } else if (_address == 0) {
+            _address = cSecondLineAddress + cLineLength - 1;
+        } else {
+            --_address;
+        }
+    }
+}
+
+
+uint8_t Hd44780::getDisplayIndex(uint8_t address) const
+{
+    if (!_isTwoLineMode) {
+        return address % cDisplayMemorySize;
+    }
+    if (address >= cSecondLineAddress) {
+        return cLineLength + ((address - cSecondLineAddress) % cLineLength);
+    }
+    return address % cLineLength;
+}
+
+
+}
+
@@ -0,0 +1,140 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+namespace Host {
+
+
+/// A simulated HD44780 compatible LCD controller with a 16x2 display.
+///
+/// The controller is driven through its pins. A value is latched at the
+/// falling edge of the enable signal. After power on, the controller is
+/// in the 8 bit mode, so the initialisation sequence of the libraries
+/// works like on the real chip. Reads from the controller are ignored.
+///
+class Hd44780
+{
+public:
+    /// The number of visible columns.
+    ///
+    static const uint8_t cColumnCount = 16;
+
+    /// The number of visible rows.
+    ///
+    static const uint8_t cRowCount = 2;
+
+    /// The number of custom characters.
+    ///
+    static const uint8_t cCustomCharacterCount = 8;
+
+public:
+    /// Create a controller in the power-on reset state.
+    ///
+    Hd44780();
+
+public:
+    /// Set the state after the internal power-on reset.
+    ///
+    void powerOnReset();
+
+    /// Set the level of the pins.
+    ///
+    /// @param rs The register select pin.
+    /// @param rw The read/write pin.
+    /// @param enable The enable pin.
+    /// @param data The data pins D4-D7 in bit 0-3. In the 8 bit mode these
+    ///    are the upper 4 bits, the lower data pins are not connected.
+    ///
+    void setPins(bool rs, bool rw, bool enable, uint8_t data);
+
+    /// Get the character code displayed at a position.
+    ///
+    uint8_t getCharacter(uint8_t row, uint8_t column) const;
+
+    /// Get the bitmap of a custom character.
+    ///
+    /// @param index The index of the character 0-7.
+    /// @return A pointer to the 8 rows of the character.
+    ///
+    const uint8_t* getCustomCharacter(uint8_t index) const;
+
+    /// Check if the display is switched on.
+    ///
+    bool isDisplayOn() const;
+
+    /// Get the number of executed instructions.
+    ///
+    uint32_t getInstructionCount() const;
+
+    /// Get the number of data writes into the display or character memory.
+    ///
+    uint32_t getDataWriteCount() const;
+
+    /// Print the visible characters into a file.
+    ///
+    /// Custom characters are shown as superscript digits with their index.
+    ///
+    void print(FILE *file) const;
+
+private:
+    /// Execute a complete 8 bit value.
+    ///
+    void execute(bool isData, uint8_t value);
+
+    /// Write a data byte at the current address.
+    ///
+    void writeData(uint8_t value);
+
+    /// Move the address counter after an access.
+    ///
+    void moveAddress();
+
+    /// Get the index in the display memory for an address.
+    ///
+    uint8_t getDisplayIndex(uint8_t address) const;
+
+private:
+    uint8_t _displayMemory[80]; ///< The display data RAM.
+    uint8_t _characterMemory[64]; ///< The character generator RAM.
+    uint8_t _address; ///< The address counter.
+    bool _isCharacterAddress; ///< If the address counter points into the character memory.
+    bool _isIncrement; ///< If the address increments after an access.
+    bool _isShiftOnWrite; ///< If the display shifts after a write.
+    bool _isDisplayOn; ///< If the display is on.
+    bool _isCursorOn; ///< If the cursor is visible.
+    bool _isBlinkOn; ///< If the cursor blinks.
+    bool _isFourBitMode; ///< If the 4 bit interface is used.
+    bool _isTwoLineMode; ///< If the display uses two lines.
+    uint8_t _displayShift; ///< The display shift in characters.
+    bool _isEnabled; ///< The last level of the enable pin.
+    bool _hasHighNibble; ///< If the upper nibble was received in the 4 bit mode.
+    uint8_t _highNibble; ///< The received upper nibble.
+    uint32_t _instructionCount; ///< The number of executed instructions.
+    uint32_t _dataWriteCount; ///< The number of data writes.
+};
+
+
+}
+
@@ -0,0 +1,174 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "I2cBus.h"
+
+
+#include "BusMonitor.h"
+#include "TraceLog.h"
+#include "VirtualTime.h"
+
+
+namespace Host {
+namespace I2cBus {
+
+
+/// The number of possible 7 bit addresses.
+///
+static const uint8_t cAddressCount = 0x80;
+
+/// The default clock frequency of the bus.
+///
+static const uint32_t cDefaultClock = 100000;
+
+/// The devices for all addresses.
+///
+static I2cDevice *gDevices[cAddressCount] = {};
+
+/// The current clock frequency.
+///
+static uint32_t gClock = cDefaultClock;
+
+/// The faults of all devices.
+///
+static Fault gFaults[cAddressCount] = {};
+
+/// The number of aborted transactions.
+///
+static uint32_t gAbortCount = 0;
+
+
+void attach(uint8_t address, I2cDevice *device)
+{
+    if (address < cAddressCount) {
+        gDevices[address] = device;
+    }
+}
+
+
+void detach(uint8_t address)
+{
+    attach(address, nullptr);
+}
+
+
+I2cDevice* getDevice(uint8_t address)
+{
+    if (address < cAddressCount && gFaults[address] != Fault::Nack) {
+        return gDevices[address];
+    }
+    return nullptr;
+}
+
+
+void setFault(uint8_t address, Fault fault)
+{
+    if (address < cAddressCount) {
+        gFaults[address] = fault;
+    }
+}
+
+
+Fault getFault(uint8_t address)
+{
+    if (address < cAddressCount) {
+        return gFaults[address];
+    }
+    return Fault::None;
+}
+
+
+void recordAbort()
+{
+    ++gAbortCount;
+}
+
+
+uint32_t getAbortCount()
+{
+    return gAbortCount;
+}
+
+
+void setClock(uint32_t frequency)
+{
+    gClock = (frequency != 0) ? frequency : cDefaultClock;
+}
+
+
+uint32_t getClock()
+{
+    return gClock;
+}
+
+
+void record(uint8_t address, bool isRead, uint8_t count, bool sendStop, bool isAcknowledged)
+{
+    BusMonitor::Transaction transaction;
+    transaction.startMicros = VirtualTime::getMicros();
+    transaction.address = address;
+    transaction.isRead = isRead;
+    transaction.byteCount = isAcknowledged ? count : 0;
+    transaction.isStop = sendStop;
+    transaction.isAcknowledged = isAcknowledged;
+    BusMonitor::record(transaction);
+    const uint64_t durationMicros = getTransactionNanos(transaction.byteCount, sendStop, gClock) / 1000;
+    TraceLog::recordTransaction(transaction, durationMicros);
+    VirtualTime::advance(durationMicros);
+}
+
+
+bool write(uint8_t address, const uint8_t *data, uint8_t count, bool sendStop)
+{
+    I2cDevice *device = getDevice(address);
+    record(address, false, count, sendStop, device != nullptr);
+    if (device == nullptr) {
+        return false;
+    }
+    device->i2cWrite(data, count);
+    return true;
+}
+
+
+bool read(uint8_t address, uint8_t *data, uint8_t count, bool sendStop)
+{
+    I2cDevice *device = getDevice(address);
+    record(address, true, count, sendStop, device != nullptr);
+    if (device == nullptr) {
+        return false;
+    }
+    device->i2cRead(data, count);
+    return true;
+}
+
+
+uint32_t getTransactionNanos(uint8_t byteCount, bool sendStop, uint32_t frequency)
+{
+    // Start condition, address byte and all data bytes with the acknowledge bit.
+    uint32_t bitCount = 1 + 9 + 9 * static_cast<uint32_t>(byteCount);
+    if (sendStop) {
+        ++bitCount;
+    }
+    return static_cast<uint32_t>((static_cast<uint64_t>(bitCount) * 1000000000ull) / frequency);
+}
+
+
+}
+}
+
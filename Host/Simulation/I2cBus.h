@@ -0,0 +1,164 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <stdint.h>
+
+
+namespace Host {
+
+
+/// The interface for a simulated device on the I2C bus.
+///
+class I2cDevice
+{
+public:
+    virtual ~I2cDevice() = default;
+
+public:
+    /// Called for a write transaction addressed to this device.
+    ///
+    /// @param data The bytes written by the master.
+    /// @param count The number of bytes.
+    ///
+    virtual void i2cWrite(const uint8_t *data, uint8_t count) = 0;
+
+    /// Called for a read transaction addressed to this device.
+    ///
+    /// @param data The buffer to fill with the bytes for the master.
+    /// @param count The number of requested bytes.
+    ///
+    virtual void i2cRead(uint8_t *data, uint8_t count) = 0;
+};
+
+
+/// The simulated I2C bus, which connects the simulated TWI unit with the devices.
+///
+/// Every transaction is reported to the `BusMonitor` and advances the
+/// virtual time by the estimated duration on the bus.
+///
+namespace I2cBus {
+
+
+/// A simulated fault of a device.
+///
+enum class Fault : uint8_t {
+    None, ///< The device works normally.
+    HoldClock, ///< The device holds SCL low after its address, forever.
+    Nack, ///< The device does not acknowledge its address.
+};
+
+
+/// Attach a device to the bus.
+///
+/// @param address The 7 bit address of the device.
+/// @param device The device. The caller keeps the ownership.
+///
+void attach(uint8_t address, I2cDevice *device);
+
+/// Detach the device with the given address from the bus.
+///
+void detach(uint8_t address);
+
+/// Get the device for an address.
+///
+/// @return The device or `nullptr` if no device responds to this address,
+///    also if the device has the fault `Fault::Nack`.
+///
+I2cDevice* getDevice(uint8_t address);
+
+/// Set the fault of a device.
+///
+/// @param address The 7 bit address of the device.
+/// @param fault The fault, `Fault::None` to repair the device.
+///
+void setFault(uint8_t address, Fault fault);
+
+/// Get the fault of a device.
+///
+Fault getFault(uint8_t address);
+
+/// Record a transaction which the master aborted while a device held the clock.
+///
+void recordAbort();
+
+/// Get the number of aborted transactions since the start of the simulation.
+///
+uint32_t getAbortCount();
+
+/// Set the clock frequency of the bus.
+///
+void setClock(uint32_t frequency);
+
+/// Get the clock frequency of the bus.
+///
+uint32_t getClock();
+
+/// Execute a write transaction.
+///
+/// @param address The 7 bit address of the device.
+/// @param data The bytes to write.
+/// @param count The number of bytes.
+/// @param sendStop If the transaction ends with a stop condition.
+/// @return `true` if a device acknowledged the address.
+///
+bool write(uint8_t address, const uint8_t *data, uint8_t count, bool sendStop);
+
+/// Execute a read transaction.
+///
+/// @param address The 7 bit address of the device.
+/// @param data The buffer for the read bytes.
+/// @param count The number of bytes to read.
+/// @param sendStop If the transaction ends with a stop condition.
+/// @return `true` if a device acknowledged the address.
+///
+bool read(uint8_t address, uint8_t *data, uint8_t count, bool sendStop);
+
+/// Record a transaction and let the virtual time pass.
+///
+/// `write()` and `read()` record their transactions. Use this method for
+/// transactions which are executed byte by byte, like in the simulated
+/// TWI unit, after the last byte.
+///
+/// @param address The 7 bit address of the device.
+/// @param isRead `true` for a read, `false` for a write.
+/// @param count The number of data bytes.
+/// @param sendStop If the transaction ends with a stop condition.
+/// @param isAcknowledged If a device acknowledged the address.
+///
+void record(uint8_t address, bool isRead, uint8_t count, bool sendStop, bool isAcknowledged);
+
+/// Estimate the duration of a transaction on the bus.
+///
+/// This counts the start condition, the address byte, all data bytes
+/// with their acknowledge bits and the optional stop condition.
+///
+/// @param byteCount The number of data bytes.
+/// @param sendStop If the transaction ends with a stop condition.
+/// @param frequency The clock frequency of the bus.
+/// @return The duration in nanoseconds.
+///
+uint32_t getTransactionNanos(uint8_t byteCount, bool sendStop, uint32_t frequency);
+
+
+}
+}
+
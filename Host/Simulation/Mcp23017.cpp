@@ -0,0 +1,176 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Mcp23017.h"
+
+
+namespace Host {
+
+
+// Register indexes for port A, port B is the next register.
+static const uint8_t cIoDirA = 0x00;
+static const uint8_t cIPolA = 0x02;
+static const uint8_t cIoCon = 0x0a; // Mirrored at 0x0b.
+static const uint8_t cGpPuA = 0x0c;
+static const uint8_t cGpioA = 0x12;
+static const uint8_t cOLatA = 0x14;
+
+// The bits of IOCON.
+static const uint8_t cIoConBank = 0x80;
+static const uint8_t cIoConSeqOp = 0x20;
+
+// In bank mode 1, the registers of port B start at this address.
+static const uint8_t cBank1PortB = 0x10;
+static const uint8_t cBank1LastRegister = 0x0a;
+
+
+Mcp23017::Mcp23017()
+    : _pointer(0), _inputLevels(0), _inputDrivenMask(0), _pinLevels(0)
+{
+    powerOnReset();
+}
+
+
+void Mcp23017::powerOnReset()
+{
+    for (uint8_t i = 0; i < cRegisterCount; ++i) {
+        _registers[i] = 0;
+    }
+    _registers[cIoDirA] = 0xff;
+    _registers[cIoDirA + 1] = 0xff;
+    _pointer = 0;
+    _pinLevels = getPinLevels();
+}
+
+
+void Mcp23017::setInputs(uint16_t levels, uint16_t drivenMask)
+{
+    _inputLevels = levels;
+    _inputDrivenMask = drivenMask;
+}
+
+
+uint16_t Mcp23017::getPinLevels() const
+{
+    const uint16_t inputMask = getPair(cIoDirA);
+    return (getPair(cOLatA) & ~inputMask) | inputMask;
+}
+
+
+uint8_t Mcp23017::getRegister(uint8_t index) const
+{
+    if (index >= cRegisterCount) {
+        return 0;
+    }
+    if (index == cGpioA || index == cGpioA + 1) {
+        const uint8_t shift = (index == cGpioA) ? 0 : 8;
+        const uint8_t inputMask = _registers[cIoDirA + (index - cGpioA)];
+        const uint8_t pullUps = _registers[cGpPuA + (index - cGpioA)];
+        const uint8_t driven = static_cast<uint8_t>(_inputDrivenMask >> shift);
+        uint8_t inputs = (static_cast<uint8_t>(_inputLevels >> shift) & driven) | (pullUps & ~driven);
+        inputs ^= _registers[cIPolA + (index - cGpioA)];
+        return (_registers[cOLatA + (index - cGpioA)] & ~inputMask) | (inputs & inputMask);
+    }
+    return _registers[index];
+}
+
+
+void Mcp23017::i2cWrite(const uint8_t *data, uint8_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    _pointer = data[0];
+    for (uint8_t i = 1; i < count; ++i) {
+        const uint8_t index = getRegisterIndex(_pointer);
+        if (index == cGpioA || index == cGpioA + 1) {
+            // A write to the port sets the output latch.
+            _registers[index + (cOLatA - cGpioA)] = data[i];
+        } else if (index == cIoCon || index == cIoCon + 1) {
+            _registers[cIoCon] = data[i];
+            _registers[cIoCon + 1] = data[i];
+        } else if (index < cRegisterCount) {
+            _registers[index] = data[i];
+        }
+        // The pins change with the acknowledge of each byte.
+        const uint16_t levels = getPinLevels();
+        if (levels != _pinLevels) {
+            _pinLevels = levels;
+            outputChanged(levels);
+        }
+        _pointer = getNextAddress(_pointer);
+    }
+}
+
+
+void Mcp23017::i2cRead(uint8_t *data, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; ++i) {
+        data[i] = getRegister(getRegisterIndex(_pointer));
+        _pointer = getNextAddress(_pointer);
+    }
+}
+
+
+void Mcp23017::outputChanged(uint16_t levels)
+{
+    (void)levels;
+}
+
+
+uint16_t Mcp23017::getPair(uint8_t indexA) const
+{
+    return static_cast<uint16_t>(_registers[indexA]) | (static_cast<uint16_t>(_registers[indexA + 1]) << 8);
+}
+
+
+uint8_t Mcp23017::getRegisterIndex(uint8_t address) const
+{
+    if ((_registers[cIoCon] & cIoConBank) == 0) {
+        return (address < cRegisterCount) ? address : cRegisterCount;
+    }
+    const uint8_t reg = address & 0x0f;
+    if (address >= 2 * cBank1PortB || reg > cBank1LastRegister) {
+        return cRegisterCount;
+    }
+    return reg * 2 + ((address >= cBank1PortB) ? 1 : 0);
+}
+
+
+uint8_t Mcp23017::getNextAddress(uint8_t address) const
+{
+    const bool isBank1 = (_registers[cIoCon] & cIoConBank) != 0;
+    if ((_registers[cIoCon] & cIoConSeqOp) != 0) {
+        // Sequential operation is disabled.
+        return isBank1 ? address : (address ^ 1);
+    }
+    if (!isBank1) {
+        return (address + 1) % cRegisterCount;
+    }
+    if (address == cBank1LastRegister) {
+        return cBank1PortB;
+    } else if (address >= cBank1PortB + cBank1LastRegister) {
+        return 0;
+    }
+    return address + 1;
+}
+
+
+}
+
@@ -0,0 +1,125 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "I2cBus.h"
+
+#include <stdint.h>
+
+
+namespace Host {
+
+
+/// A simulated Microchip MCP23017 I/O expander.
+///
+/// The model keeps the 22 registers in the default `IOCON.BANK = 0`
+/// layout. The register addresses on the bus follow the BANK bit of
+/// IOCON, which is mirrored at both IOCON addresses. The register pointer
+/// increments after each byte, or with the SEQOP bit set, stays at the
+/// register in bank mode 1 and toggles between the A/B pair in bank
+/// mode 0. A write to GPIO sets the output latch. A read from GPIO returns
+/// the latch for outputs and the external level for inputs, inverted by
+/// IPOL.
+///
+/// Subclasses connect the pins to other hardware by overriding
+/// `outputChanged()`. The interrupt outputs are not implemented.
+///
+class Mcp23017 : public I2cDevice
+{
+public:
+    /// The number of registers.
+    ///
+    static const uint8_t cRegisterCount = 0x16;
+
+public:
+    /// Create an expander in the power-on reset state.
+    ///
+    Mcp23017();
+
+    /// dtor
+    ///
+    virtual ~Mcp23017() = default;
+
+public:
+    /// Set all registers to the values after a power-on reset.
+    ///
+    void powerOnReset();
+
+    /// Set the level of the external signals at the pins.
+    ///
+    /// Only pins configured as inputs read this level.
+    ///
+    /// @param levels The levels for the pins GPA0-7 (bit 0-7) and GPB0-7 (bit 8-15).
+    /// @param drivenMask A bit mask with all pins which are driven externally.
+    ///    Pins without a driver read high if the pull-up is enabled, else low.
+    ///
+    void setInputs(uint16_t levels, uint16_t drivenMask);
+
+    /// Get the levels of all pins, as seen from the outside.
+    ///
+    /// Output pins have the level of the latch. Input pins are high.
+    ///
+    uint16_t getPinLevels() const;
+
+    /// Get the value of a register.
+    ///
+    /// @param index The register index in the `IOCON.BANK = 0` layout.
+    ///
+    uint8_t getRegister(uint8_t index) const;
+
+public: // Implement I2cDevice
+    void i2cWrite(const uint8_t *data, uint8_t count) override;
+    void i2cRead(uint8_t *data, uint8_t count) override;
+
+protected:
+    /// Called after a write changed the level of output pins.
+    ///
+    /// @param levels The new levels of all pins, see getPinLevels().
+    ///
+    virtual void outputChanged(uint16_t levels);
+
+private:
+    /// Get a 16 bit value from a register pair.
+    ///
+    uint16_t getPair(uint8_t indexA) const;
+
+    /// Get the register index for an address on the bus.
+    ///
+    /// @return The index in the `IOCON.BANK = 0` layout, or `cRegisterCount`
+    ///    for an unimplemented address.
+    ///
+    uint8_t getRegisterIndex(uint8_t address) const;
+
+    /// Get the address after an access, following the BANK and SEQOP bits.
+    ///
+    uint8_t getNextAddress(uint8_t address) const;
+
+private:
+    uint8_t _registers[cRegisterCount]; ///< The register values.
+    uint8_t _pointer; ///< The register address for the next access.
+    uint16_t _inputLevels; ///< The external levels at the pins.
+    uint16_t _inputDrivenMask; ///< The pins driven from the outside.
+    uint16_t _pinLevels; ///< The last reported pin levels.
+};
+
+
+}
+
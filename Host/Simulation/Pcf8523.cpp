@@ -0,0 +1,522 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Pcf8523.h"
+
+
+#include "VirtualTime.h"
+
+
+namespace Host {
+
+
+// Register indexes.
+static const uint8_t cControl1 = 0x00;
+static const uint8_t cControl2 = 0x01;
+static const uint8_t cControl3 = 0x02;
+static const uint8_t cSeconds = 0x03;
+static const uint8_t cYears = 0x09;
+static const uint8_t cMinuteAlarm = 0x0a;
+static const uint8_t cWeekdayAlarm = 0x0d;
+static const uint8_t cOffset = 0x0e;
+static const uint8_t cTimerAndClockOut = 0x0f;
+static const uint8_t cTimerAFrequency = 0x10;
+static const uint8_t cTimerBFrequency = 0x12;
+
+// Register bits.
+static const uint8_t cControl1Stop = 0x20;
+static const uint8_t cControl1Sie = 0x04;
+static const uint8_t cControl1Aie = 0x02;
+static const uint8_t cControl2Sf = 0x10;
+static const uint8_t cControl2Af = 0x08;
+static const uint8_t cControl2Flags = 0xf8;
+static const uint8_t cControl3Blf = 0x04;
+static const uint8_t cControl3Bsf = 0x08;
+static const uint8_t cControl3LowBatteryDetectionOff = 0x80;
+static const uint8_t cTimerAndClockOutTam = 0x80;
+static const uint8_t cSecondsOs = 0x80;
+static const uint8_t cAlarmDisabled = 0x80;
+
+/// The command for a software reset, written into Control1.
+///
+static const uint8_t cSoftwareReset = 0x58;
+
+/// The number of seconds per minute and day.
+///
+static const uint32_t cSecondsPerMinute = 60;
+static const uint32_t cSecondsPerDay = 86400;
+
+/// The length of a pulsed second interrupt, 1/64 s.
+///
+static const uint32_t cSecondPulseMicros = 15625;
+
+/// The longest alarm period, the day of month alarm.
+///
+static const uint32_t cMaximumAlarmSearch = 31 * cSecondsPerDay;
+
+/// The number of days per month, for non leap years.
+///
+static const uint8_t cDaysPerMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+
+/// The calendar fields of a time.
+///
+struct Calendar {
+    uint8_t year; ///< The year since 2000.
+    uint8_t month; ///< The month 1-12.
+    uint8_t day; ///< The day 1-31.
+    uint8_t hour; ///< The hour 0-23.
+    uint8_t minute; ///< The minute 0-59.
+    uint8_t second; ///< The second 0-59.
+    uint8_t dayOfWeek; ///< The day of week, 0 = Sunday.
+};
+
+
+/// Convert BCD into binary.
+///
+static inline uint8_t convertBcdToBin(uint8_t bcd)
+{
+    return (bcd & 0xf) + ((bcd >> 4) * 10);
+}
+
+
+/// Convert binary into BCD.
+///
+static inline uint8_t convertBinToBcd(uint8_t bin)
+{
+    return (bin % 10) + ((bin / 10) << 4);
+}
+
+
+/// Get the number of days in a month.
+///
+static uint8_t getDaysInMonth(uint8_t year, uint8_t month)
+{
+    if (month == 2 && (year % 4) == 0) {
+        return 29; // The chip uses this simple rule for 2000-2099.
+    }
+    return cDaysPerMonth[month - 1];
+}
+
+
+/// Split a time into the calendar fields.
+///
+static Calendar getCalendar(uint32_t time)
+{
+    Calendar calendar;
+    uint32_t days = time / cSecondsPerDay;
+    const uint32_t secondOfDay = time % cSecondsPerDay;
+    calendar.hour = static_cast<uint8_t>(secondOfDay / 3600);
+    calendar.minute = static_cast<uint8_t>((secondOfDay / 60) % 60);
+    calendar.second = static_cast<uint8_t>(secondOfDay % 60);
+    calendar.dayOfWeek = static_cast<uint8_t>((days + 6) % 7); // 2000-01-01 was a Saturday.
+    calendar.year = 0;
+    while (true) {
+        const uint32_t daysInYear = ((calendar.year % 4) == 0) ? 366 : 365;
+        if (days < daysInYear) {
+            break;
+        }
+        days -= daysInYear;
+        ++calendar.year;
+    }
+    calendar.month = 1;
+    while (days >= getDaysInMonth(calendar.year, calendar.month)) {
+        days -= getDaysInMonth(calendar.year, calendar.month);
+        ++calendar.month;
+    }
+    calendar.day = static_cast<uint8_t>(days + 1);
+    return calendar;
+}
+
+
+/// Combine calendar fields into a time.
+///
+/// Out of range values are clamped, like the counters of the chip would
+/// never hold them.
+///
+static uint32_t getTime(const Calendar &calendar)
+{
+    const uint8_t year = (calendar.year < 100) ? calendar.year : 99;
+    const uint8_t month = (calendar.month >= 1 && calendar.month <= 12) ? calendar.month : 1;
+    uint32_t days = 0;
+    for (uint8_t i = 0; i < year; ++i) {
+        days += ((i % 4) == 0) ? 366 : 365;
+    }
+    for (uint8_t i = 1; i < month; ++i) {
+        days += getDaysInMonth(year, i);
+    }
+    if (calendar.day >= 1) {
+        days += calendar.day - 1;
+    }
+    return days * cSecondsPerDay
+        + static_cast<uint32_t>(calendar.hour % 24) * 3600
+        + static_cast<uint32_t>(calendar.minute % 60) * 60
+        + static_cast<uint32_t>(calendar.second % 60);
+}
+
+
+Pcf8523::Pcf8523()
+    : _pointer(0), _referenceTime(0), _referenceRtcSeconds(0), _alarmCheckTime(0), _isBackupBatteryLow(false)
+{
+    powerOnReset();
+}
+
+
+void Pcf8523::powerOnReset()
+{
+    for (uint8_t i = 0; i < cRegisterCount; ++i) {
+        _registers[i] = 0;
+    }
+    softwareReset();
+    storeTime(0);
+    _pointer = 0;
+}
+
+
+void Pcf8523::configure(uint32_t time, uint8_t alarmHour, uint8_t alarmMinute)
+{
+    powerOnReset();
+    _registers[cControl1] = cControl1Aie;
+    _registers[cControl3] = 0x20; // Direct switch-over with low battery detection.
+    _registers[cTimerAndClockOut] = 0x38; // No clock output.
+    setAlarm(alarmHour, alarmMinute);
+    storeTime(time);
+    _registers[cSeconds] &= ~cSecondsOs;
+}
+
+
+void Pcf8523::setTime(uint32_t time)
+{
+    storeTime(time);
+}
+
+
+uint32_t Pcf8523::getTime() const
+{
+    if ((_registers[cControl1] & cControl1Stop) != 0) {
+        return _referenceTime;
+    }
+    return _referenceTime + (VirtualTime::getRtcSeconds() - _referenceRtcSeconds);
+}
+
+
+void Pcf8523::setAlarm(uint8_t hour, uint8_t minute)
+{
+    update();
+    _registers[cMinuteAlarm] = convertBinToBcd(minute % 60);
+    _registers[cMinuteAlarm + 1] = convertBinToBcd(hour % 24);
+    _registers[cMinuteAlarm + 2] = cAlarmDisabled | 0x01;
+    _registers[cWeekdayAlarm] = cAlarmDisabled;
+}
+
+
+void Pcf8523::setAlarmFlag(bool enabled)
+{
+    update();
+    if (enabled) {
+        _registers[cControl2] |= cControl2Af;
+    } else {
+        _registers[cControl2] &= ~cControl2Af;
+    }
+}
+
+
+void Pcf8523::setBackupBatteryLow(bool enabled)
+{
+    _isBackupBatteryLow = enabled;
+}
+
+
+bool Pcf8523::isInterruptActive()
+{
+    update();
+    if (isInterruptHeld()) {
+        return true;
+    }
+    return isSecondInterruptRunning() && (_registers[cTimerAndClockOut] & cTimerAndClockOutTam) != 0
+        && VirtualTime::getRtcSubsecondMicros() < cSecondPulseMicros;
+}
+
+
+uint64_t Pcf8523::getNextInterruptMicros()
+{
+    update();
+    if (isInterruptHeld()) {
+        return cNoInterrupt;
+    }
+    // Each second starts a new second interrupt.
+    if (isSecondInterruptRunning()) {
+        return VirtualTime::getNextRtcSecondMicros();
+    }
+    if ((_registers[cControl1] & (cControl1Aie | cControl1Stop)) != cControl1Aie) {
+        return cNoInterrupt;
+    }
+    const uint32_t time = getTime();
+    uint32_t alarmTime;
+    if (!findAlarm(time, time + cMaximumAlarmSearch, alarmTime)) {
+        return cNoInterrupt;
+    }
+    return VirtualTime::getMicrosAtRtcSeconds(_referenceRtcSeconds + (alarmTime - _referenceTime));
+}
+
+
+uint64_t Pcf8523::getNextInterruptChangeMicros() const
+{
+    const uint32_t subsecondMicros = VirtualTime::getRtcSubsecondMicros();
+    if (subsecondMicros < cSecondPulseMicros) {
+        return VirtualTime::getMicros() - subsecondMicros + cSecondPulseMicros;
+    }
+    return VirtualTime::getNextRtcSecondMicros();
+}
+
+
+uint8_t Pcf8523::getRegister(uint8_t index)
+{
+    update();
+    if (index >= cRegisterCount) {
+        return 0;
+    }
+    uint8_t value = _registers[index];
+    if (index == cControl3) {
+        value &= ~cControl3Blf;
+        if (_isBackupBatteryLow && (value & cControl3LowBatteryDetectionOff) == 0) {
+            value |= cControl3Blf;
+        }
+    }
+    return value;
+}
+
+
+uint32_t Pcf8523::getSecondsSince2000(uint16_t year, uint8_t month, uint8_t day,
+    uint8_t hour, uint8_t minute, uint8_t second)
+{
+    Calendar calendar;
+    calendar.year = static_cast<uint8_t>((year >= 2000) ? (year - 2000) : 0);
+    calendar.month = month;
+    calendar.day = day;
+    calendar.hour = hour;
+    calendar.minute = minute;
+    calendar.second = second;
+    calendar.dayOfWeek = 0;
+    return Host::getTime(calendar);
+}
+
+
+void Pcf8523::i2cWrite(const uint8_t *data, uint8_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    update();
+    _pointer = data[0] % cRegisterCount;
+    bool isTimeWritten = false;
+    for (uint8_t i = 1; i < count; ++i) {
+        if (_pointer >= cSeconds && _pointer <= cYears) {
+            isTimeWritten = true;
+        }
+        writeRegister(_pointer, data[i]);
+        _pointer = (_pointer + 1) % cRegisterCount;
+    }
+    // The time counters restart with the written values.
+    if (isTimeWritten) {
+        const uint8_t osFlag = _registers[cSeconds] & cSecondsOs;
+        storeTime(readTimeRegisters());
+        _registers[cSeconds] |= osFlag;
+    }
+}
+
+
+void Pcf8523::i2cRead(uint8_t *data, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; ++i) {
+        data[i] = getRegister(_pointer);
+        _pointer = (_pointer + 1) % cRegisterCount;
+    }
+}
+
+
+void Pcf8523::update()
+{
+    const uint32_t time = getTime();
+    if (time != _alarmCheckTime) {
+        uint32_t alarmTime;
+        if (time > _alarmCheckTime && findAlarm(_alarmCheckTime, time, alarmTime)) {
+            _registers[cControl2] |= cControl2Af;
+        }
+        if ((_registers[cControl1] & cControl1Sie) != 0) {
+            _registers[cControl2] |= cControl2Sf;
+        }
+        _alarmCheckTime = time;
+    }
+    writeTimeRegisters(time);
+}
+
+
+void Pcf8523::storeTime(uint32_t time)
+{
+    _referenceTime = time;
+    _referenceRtcSeconds = VirtualTime::getRtcSeconds();
+    _alarmCheckTime = time;
+    writeTimeRegisters(time);
+}
+
+
+void Pcf8523::writeTimeRegisters(uint32_t time)
+{
+    const Calendar calendar = getCalendar(time);
+    _registers[cSeconds] = (_registers[cSeconds] & cSecondsOs) | convertBinToBcd(calendar.second);
+    _registers[cSeconds + 1] = convertBinToBcd(calendar.minute);
+    _registers[cSeconds + 2] = convertBinToBcd(calendar.hour);
+    _registers[cSeconds + 3] = convertBinToBcd(calendar.day);
+    _registers[cSeconds + 4] = calendar.dayOfWeek;
+    _registers[cSeconds + 5] = convertBinToBcd(calendar.month);
+    _registers[cSeconds + 6] = convertBinToBcd(calendar.year);
+}
+
+
+uint32_t Pcf8523::readTimeRegisters() const
+{
+    Calendar calendar;
+    calendar.second = convertBcdToBin(_registers[cSeconds] & 0x7f);
+    calendar.minute = convertBcdToBin(_registers[cSeconds + 1] & 0x7f);
+    calendar.hour = convertBcdToBin(_registers[cSeconds + 2] & 0x3f);
+    calendar.day = convertBcdToBin(_registers[cSeconds + 3] & 0x3f);
+    calendar.dayOfWeek = _registers[cSeconds + 4] & 0x07;
+    calendar.month = convertBcdToBin(_registers[cSeconds + 5] & 0x1f);
+    calendar.year = convertBcdToBin(_registers[cSeconds + 6]);
+    return Host::getTime(calendar);
+}
+
+
+bool Pcf8523::isInterruptHeld() const
+{
+    const uint8_t control1 = _registers[cControl1];
+    const uint8_t control2 = _registers[cControl2];
+    if ((control1 & cControl1Aie) != 0 && (control2 & cControl2Af) != 0) {
+        return true;
+    }
+    // Only in permanent mode, the second interrupt holds INT1 until SF is cleared.
+    return (control1 & cControl1Sie) != 0 && (control2 & cControl2Sf) != 0
+        && (_registers[cTimerAndClockOut] & cTimerAndClockOutTam) == 0;
+}
+
+
+bool Pcf8523::isSecondInterruptRunning() const
+{
+    return (_registers[cControl1] & (cControl1Sie | cControl1Stop)) == cControl1Sie;
+}
+
+
+bool Pcf8523::isAlarmEnabled() const
+{
+    for (uint8_t i = cMinuteAlarm; i <= cWeekdayAlarm; ++i) {
+        if ((_registers[i] & cAlarmDisabled) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool Pcf8523::isAlarmMatch(uint32_t time) const
+{
+    const Calendar calendar = getCalendar(time);
+    const uint8_t values[4] = {
+        convertBinToBcd(calendar.minute),
+        convertBinToBcd(calendar.hour),
+        convertBinToBcd(calendar.day),
+        calendar.dayOfWeek
+    };
+    const uint8_t masks[4] = {0x7f, 0x3f, 0x3f, 0x07};
+    for (uint8_t i = 0; i < 4; ++i) {
+        const uint8_t alarm = _registers[cMinuteAlarm + i];
+        if ((alarm & cAlarmDisabled) == 0 && (alarm & masks[i]) != values[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool Pcf8523::findAlarm(uint32_t time, uint32_t lastTime, uint32_t &matchTime) const
+{
+    if (!isAlarmEnabled()) {
+        return false;
+    }
+    // After a long time without access, only the last period is relevant.
+    if (lastTime - time > cMaximumAlarmSearch) {
+        time = lastTime - cMaximumAlarmSearch;
+    }
+    uint32_t minuteStart = (time / cSecondsPerMinute + 1) * cSecondsPerMinute;
+    for (; minuteStart <= lastTime; minuteStart += cSecondsPerMinute) {
+        if (isAlarmMatch(minuteStart)) {
+            matchTime = minuteStart;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void Pcf8523::writeRegister(uint8_t index, uint8_t value)
+{
+    switch (index) {
+    case cControl1:
+        if (value == cSoftwareReset) {
+            softwareReset();
+        } else {
+            // Keep the time while the clock is stopped.
+            const uint32_t time = getTime();
+            _registers[cControl1] = value & 0xbf;
+            _referenceTime = time;
+            _referenceRtcSeconds = VirtualTime::getRtcSeconds();
+        }
+        break;
+    case cControl2:
+        // The flags are cleared by writing zero, a one keeps them.
+        _registers[cControl2] = (value & 0x07) | (_registers[cControl2] & value & cControl2Flags);
+        break;
+    case cControl3:
+        _registers[cControl3] = (value & 0xe3) | (_registers[cControl3] & value & cControl3Bsf);
+        break;
+    default:
+        _registers[index] = value;
+        break;
+    }
+}
+
+
+void Pcf8523::softwareReset()
+{
+    _registers[cControl1] = 0x00;
+    _registers[cControl2] = 0x00;
+    _registers[cControl3] = 0xe0;
+    _registers[cSeconds] |= cSecondsOs;
+    for (uint8_t i = cMinuteAlarm; i <= cWeekdayAlarm; ++i) {
+        _registers[i] |= cAlarmDisabled;
+    }
+    _registers[cOffset] = 0x00;
+    _registers[cTimerAndClockOut] = 0x00;
+    _registers[cTimerAFrequency] |= 0x07;
+    _registers[cTimerBFrequency] |= 0x77;
+}
+
+
+}
+
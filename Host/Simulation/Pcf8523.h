@@ -0,0 +1,217 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "I2cBus.h"
+
+#include <stdint.h>
+
+
+namespace Host {
+
+
+/// A simulated NXP PCF8523 real time clock.
+///
+/// The model keeps the 20 registers of the chip. The time registers are
+/// derived from the RTC time base of the virtual clock, so the time keeps
+/// running while the device is powered off. Implemented are:
+///
+/// - Auto increment of the register pointer for reads and writes.
+/// - The time registers in BCD format, including the STOP bit.
+/// - The alarm registers with the AEN bits and the AF flag, which is set
+///   when the enabled alarm fields match at the start of a minute.
+/// - The flags in Control2 and BSF in Control3, which are cleared by
+///   writing a zero, and the read-only BLF flag.
+/// - The second interrupt with the SF flag, as permanent or as pulsed
+///   interrupt (TAM), where INT1 is active for 1/64 s at the start of
+///   each second.
+/// - The software reset, by writing 0x58 into Control1.
+///
+/// Not implemented are the 12 hour mode, the timers, the offset
+/// correction and the clock output. The weekday register is derived
+/// from the date.
+///
+class Pcf8523 : public I2cDevice
+{
+public:
+    /// The address of the chip on the bus.
+    ///
+    static const uint8_t cAddress = 0x68;
+
+    /// The number of registers.
+    ///
+    static const uint8_t cRegisterCount = 0x14;
+
+    /// The value returned by getNextInterruptMicros() if no interrupt is scheduled.
+    ///
+    static const uint64_t cNoInterrupt = UINT64_MAX;
+
+public:
+    /// Create a chip in the power-on reset state.
+    ///
+    Pcf8523();
+
+public:
+    /// Set all registers to the values after a power-on reset.
+    ///
+    /// The time is set to 2000-01-01 00:00:00 and the OS flag is set.
+    ///
+    void powerOnReset();
+
+    /// Set all registers to the values which `Clock::reset()` writes.
+    ///
+    /// @param time The time in seconds since 2000-01-01 00:00:00.
+    /// @param alarmHour The hour of the alarm.
+    /// @param alarmMinute The minute of the alarm.
+    ///
+    void configure(uint32_t time, uint8_t alarmHour, uint8_t alarmMinute);
+
+    /// Set the current time.
+    ///
+    /// @param time The time in seconds since 2000-01-01 00:00:00.
+    ///
+    void setTime(uint32_t time);
+
+    /// Get the current time.
+    ///
+    /// @return The time in seconds since 2000-01-01 00:00:00.
+    ///
+    uint32_t getTime() const;
+
+    /// Set an alarm for the hour and minute.
+    ///
+    /// This writes the alarm registers like the firmware does, with the
+    /// day and weekday alarms disabled. The alarm interrupt is not changed.
+    ///
+    void setAlarm(uint8_t hour, uint8_t minute);
+
+    /// Set or clear the alarm flag AF.
+    ///
+    /// Setting the flag while the alarm does not match simulates an old
+    /// alarm which was never cleared.
+    ///
+    void setAlarmFlag(bool enabled);
+
+    /// Set the state of the backup battery.
+    ///
+    /// The BLF flag is only set if the low battery detection is enabled
+    /// in the power management bits of Control3.
+    ///
+    void setBackupBatteryLow(bool enabled);
+
+    /// Check if the INT1 output is active.
+    ///
+    bool isInterruptActive();
+
+    /// Get the virtual time of the next falling edge on the INT1 output.
+    ///
+    /// If the alarm flag is already set, the output stays low and there
+    /// is no further edge until the flag is cleared.
+    ///
+    /// @return The virtual time in microseconds, or `cNoInterrupt`.
+    ///
+    uint64_t getNextInterruptMicros();
+
+    /// Get the virtual time of the next possible change of the INT1 output.
+    ///
+    /// Besides writes to the chip, the output can only change at the start
+    /// of a second, or at the end of a second interrupt pulse. The output
+    /// may keep its level at the returned time.
+    ///
+    /// @return The virtual time in microseconds, always in the future.
+    ///
+    uint64_t getNextInterruptChangeMicros() const;
+
+    /// Get the value of a register, like a read from the chip.
+    ///
+    uint8_t getRegister(uint8_t index);
+
+    /// Convert a date and time into the seconds since 2000-01-01 00:00:00.
+    ///
+    static uint32_t getSecondsSince2000(uint16_t year, uint8_t month, uint8_t day,
+        uint8_t hour, uint8_t minute, uint8_t second);
+
+public: // Implement I2cDevice
+    void i2cWrite(const uint8_t *data, uint8_t count) override;
+    void i2cRead(uint8_t *data, uint8_t count) override;
+
+private:
+    /// Bring the time registers and the alarm flag up to date.
+    ///
+    void update();
+
+    /// Set the time and restart the alarm detection at this time.
+    ///
+    void storeTime(uint32_t time);
+
+    /// Write the time into the time registers.
+    ///
+    void writeTimeRegisters(uint32_t time);
+
+    /// Read the time from the time registers.
+    ///
+    uint32_t readTimeRegisters() const;
+
+    /// Check if the alarm or a permanent second interrupt holds INT1 active.
+    ///
+    bool isInterruptHeld() const;
+
+    /// Check if the second interrupt is enabled and the clock is running.
+    ///
+    bool isSecondInterruptRunning() const;
+
+    /// Check if any alarm field is enabled.
+    ///
+    bool isAlarmEnabled() const;
+
+    /// Check if all enabled alarm fields match the given time.
+    ///
+    bool isAlarmMatch(uint32_t time) const;
+
+    /// Find the next start of a minute where the alarm matches.
+    ///
+    /// @param time The time to start the search, exclusive.
+    /// @param lastTime The last time to check, inclusive.
+    /// @param matchTime The variable for the found time.
+    /// @return `true` if a matching time was found.
+    ///
+    bool findAlarm(uint32_t time, uint32_t lastTime, uint32_t &matchTime) const;
+
+    /// Write a single register with the rules of the chip.
+    ///
+    void writeRegister(uint8_t index, uint8_t value);
+
+    /// Execute a software reset.
+    ///
+    void softwareReset();
+
+private:
+    uint8_t _registers[cRegisterCount]; ///< The register values.
+    uint8_t _pointer; ///< The register pointer for the next access.
+    uint32_t _referenceTime; ///< The time of the chip at the reference.
+    uint32_t _referenceRtcSeconds; ///< The RTC time base at the reference.
+    uint32_t _alarmCheckTime; ///< The last time checked for an alarm.
+    bool _isBackupBatteryLow; ///< The state of the backup battery.
+};
+
+
+}
+
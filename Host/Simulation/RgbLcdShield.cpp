@@ -0,0 +1,148 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "RgbLcdShield.h"
+
+
+#include "I2cBus.h"
+#include "VirtualTime.h"
+
+
+namespace Host {
+
+
+// The pins of the expander, GPA0-7 are 0-7 and GPB0-7 are 8-15.
+static const uint8_t cRsPin = 15;
+static const uint8_t cRwPin = 14;
+static const uint8_t cEnablePin = 13;
+static const uint8_t cDataPins[4] = {12, 11, 10, 9}; // D4-D7
+static const uint8_t cBacklightPins[3] = {6, 7, 8}; // Bit 0-2 of the backlight value.
+static const uint16_t cButtonMask = 0x001f;
+static const uint16_t cLcdPinMask = 0xfe00; // GPB1-7
+
+
+/// Get the level of a pin.
+///
+static inline bool isHigh(uint16_t levels, uint8_t pin)
+{
+    return (levels & (1u << pin)) != 0;
+}
+
+
+RgbLcdShield::RgbLcdShield()
+    : _isWatchingLcd(false), _hasLcdWrite(false), _lcdWriteMicros(0),
+    _lcdPinLevels(0), _hasLcdPinChange(false), _lcdBusNanos(0)
+{
+    powerOnReset();
+}
+
+
+void RgbLcdShield::powerOnReset()
+{
+    Mcp23017::powerOnReset();
+    _lcd.powerOnReset();
+    setPressedButtons(0);
+    _lcdPinLevels = getPinLevels() & cLcdPinMask;
+    _lcdBusNanos = 0;
+}
+
+
+void RgbLcdShield::setPressedButtons(uint8_t buttons)
+{
+    // A pressed button connects the pin to GND, the others are open.
+    setInputs(0, buttons & cButtonMask);
+}
+
+
+uint8_t RgbLcdShield::getBacklight() const
+{
+    const uint16_t levels = getPinLevels();
+    uint8_t result = 0;
+    for (uint8_t i = 0; i < 3; ++i) {
+        // The LEDs are active low.
+        if (!isHigh(levels, cBacklightPins[i])) {
+            result |= (1 << i);
+        }
+    }
+    return result;
+}
+
+
+const Hd44780& RgbLcdShield::getLcd() const
+{
+    return _lcd;
+}
+
+
+void RgbLcdShield::watchLcdWrite()
+{
+    _isWatchingLcd = true;
+    _hasLcdWrite = false;
+}
+
+
+bool RgbLcdShield::getLcdWriteMicros(uint64_t &micros) const
+{
+    if (_hasLcdWrite) {
+        micros = _lcdWriteMicros;
+    }
+    return _hasLcdWrite;
+}
+
+
+uint64_t RgbLcdShield::getLcdBusNanos() const
+{
+    return _lcdBusNanos;
+}
+
+
+void RgbLcdShield::i2cWrite(const uint8_t *data, uint8_t count)
+{
+    _hasLcdPinChange = false;
+    Mcp23017::i2cWrite(data, count);
+    if (_hasLcdPinChange) {
+        _lcdBusNanos += I2cBus::getTransactionNanos(count, true, 100000);
+    }
+}
+
+
+void RgbLcdShield::outputChanged(uint16_t levels)
+{
+    if ((levels & cLcdPinMask) != _lcdPinLevels) {
+        _lcdPinLevels = levels & cLcdPinMask;
+        _hasLcdPinChange = true;
+    }
+    uint8_t data = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        if (isHigh(levels, cDataPins[i])) {
+            data |= (1 << i);
+        }
+    }
+    const uint32_t writeCount = _lcd.getInstructionCount() + _lcd.getDataWriteCount();
+    _lcd.setPins(isHigh(levels, cRsPin), isHigh(levels, cRwPin), isHigh(levels, cEnablePin), data);
+    if (_isWatchingLcd && writeCount != _lcd.getInstructionCount() + _lcd.getDataWriteCount()) {
+        _isWatchingLcd = false;
+        _hasLcdWrite = true;
+        _lcdWriteMicros = VirtualTime::getMicros();
+    }
+}
+
+
+}
+
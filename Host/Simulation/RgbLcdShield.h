@@ -0,0 +1,107 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Hd44780.h"
+#include "Mcp23017.h"
+
+
+namespace Host {
+
+
+/// The simulated Adafruit RGB LCD shield.
+///
+/// The shield connects the LCD controller, the backlight and the buttons
+/// to an MCP23017. The LCD is driven from the pins GPB1-7, the backlight
+/// LEDs from GPA6-7 and GPB0, and the buttons pull GPA0-4 to GND.
+///
+class RgbLcdShield : public Mcp23017
+{
+public:
+    /// The address of the shield on the bus.
+    ///
+    static const uint8_t cAddress = 0x20;
+
+public:
+    /// Create a shield in the power-on reset state.
+    ///
+    RgbLcdShield();
+
+public:
+    /// Reset the expander and the LCD controller.
+    ///
+    void powerOnReset();
+
+    /// Set the pressed buttons.
+    ///
+    /// @param buttons The buttons in the bits of the `BUTTON_...` masks.
+    ///
+    void setPressedButtons(uint8_t buttons);
+
+    /// Get the state of the backlight.
+    ///
+    /// @return The switched on LEDs, like the value for `setBacklight()`.
+    ///
+    uint8_t getBacklight() const;
+
+    /// Get the LCD controller.
+    ///
+    const Hd44780& getLcd() const;
+
+    /// Start to watch for the next write to the LCD controller.
+    ///
+    void watchLcdWrite();
+
+    /// Get the virtual time of the first LCD write since watchLcdWrite().
+    ///
+    /// @param micros The variable for the virtual time.
+    /// @return `true` if there was a write.
+    ///
+    bool getLcdWriteMicros(uint64_t &micros) const;
+
+    /// Get the bus time of all writes which changed the LCD pins.
+    ///
+    /// Other writes to the expander, like backlight changes, are not
+    /// counted. The value is reset with the power-on reset.
+    ///
+    /// @return The estimated bus time at 100kHz in nanoseconds.
+    ///
+    uint64_t getLcdBusNanos() const;
+
+public: // Implement I2cDevice
+    void i2cWrite(const uint8_t *data, uint8_t count) override;
+
+protected:
+    void outputChanged(uint16_t levels) override;
+
+private:
+    Hd44780 _lcd; ///< The LCD controller.
+    bool _isWatchingLcd; ///< If the next LCD write is watched.
+    bool _hasLcdWrite; ///< If a write happened since the watch started.
+    uint64_t _lcdWriteMicros; ///< The virtual time of the watched write.
+    uint16_t _lcdPinLevels; ///< The last levels of the LCD pins.
+    bool _hasLcdPinChange; ///< If the current write changed the LCD pins.
+    uint64_t _lcdBusNanos; ///< The bus time of the writes to the LCD.
+};
+
+
+}
+
@@ -0,0 +1,153 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Timeline.h"
+
+
+#include "BusMonitor.h"
+#include "CallStack.h"
+#include "VirtualTime.h"
+
+#include <vector>
+
+
+namespace Host {
+namespace Timeline {
+
+
+/// One phase of the timeline.
+///
+struct Phase {
+    std::string name; ///< The name of the phase.
+    uint64_t startMicros; ///< The virtual time at the start.
+    uint64_t endMicros; ///< The virtual time at the end.
+    uint64_t activityMicros[cActivityCount]; ///< The time per activity.
+    BusMonitor::Totals busAtStart; ///< The bus totals at the start.
+    BusMonitor::Totals busAtEnd; ///< The bus totals at the end.
+};
+
+
+/// The names of the activities for the table.
+///
+static const char* const cActivityNames[cActivityCount] = {
+    "keypad", "view", "display", "servo", "other"
+};
+
+
+/// Flag if the timeline is enabled.
+///
+static bool gEnabled = false;
+
+/// All phases, the last one is the current phase.
+///
+static std::vector<Phase> gPhases;
+
+
+/// Get the activity for a call stack.
+///
+static Activity getActivity(const std::vector<std::string> &path)
+{
+    static const std::string cViewLoopSuffix = "View::loop";
+    Activity result = Activity::Other;
+    for (const auto &name : path) {
+        if (name == "Hardware::dropFood") {
+            return Activity::Servo;
+        } else if (name == "KeyPad::scanKeys") {
+            return Activity::KeyPad;
+        } else if (name.compare(0, 9, "Display::") == 0) {
+            result = Activity::Display;
+        } else if (result == Activity::Other && name.size() >= cViewLoopSuffix.size()
+            && name.compare(name.size() - cViewLoopSuffix.size(), std::string::npos, cViewLoopSuffix) == 0) {
+            result = Activity::ViewLoop;
+        }
+    }
+    return result;
+}
+
+
+/// End the current phase at the current time.
+///
+static void endPhase()
+{
+    if (!gPhases.empty()) {
+        gPhases.back().endMicros = VirtualTime::getMicros();
+        gPhases.back().busAtEnd = BusMonitor::getTotals();
+    }
+}
+
+
+void setEnabled(bool enabled)
+{
+    gEnabled = enabled;
+}
+
+
+void beginPhase(const std::string &name)
+{
+    endPhase();
+    Phase phase = {};
+    phase.name = name;
+    phase.startMicros = VirtualTime::getMicros();
+    phase.busAtStart = BusMonitor::getTotals();
+    gPhases.push_back(phase);
+}
+
+
+void record(uint64_t micros)
+{
+    if (!gEnabled) {
+        return;
+    }
+    if (gPhases.empty()) {
+        beginPhase("start");
+    }
+    const Activity activity = getActivity(CallStack::getFirmwarePath());
+    gPhases.back().activityMicros[static_cast<uint8_t>(activity)] += micros;
+}
+
+
+void print(FILE *file)
+{
+    endPhase();
+    fprintf(file, "%-24s %10s", "Phase (ms)", "total");
+    for (const char *name : cActivityNames) {
+        fprintf(file, " %9s", name);
+    }
+    fprintf(file, " %9s %9s %7s %7s\n", "off", "i2c", "trans.", "bytes");
+    for (const auto &phase : gPhases) {
+        const uint64_t totalMicros = phase.endMicros - phase.startMicros;
+        uint64_t awakeMicros = 0;
+        fprintf(file, "%-24s %10.1f", phase.name.c_str(), totalMicros / 1000.0);
+        for (uint8_t i = 0; i < cActivityCount; ++i) {
+            fprintf(file, " %9.1f", phase.activityMicros[i] / 1000.0);
+            awakeMicros += phase.activityMicros[i];
+        }
+        const uint64_t offMicros = (totalMicros > awakeMicros) ? (totalMicros - awakeMicros) : 0;
+        fprintf(file, " %9.1f %9.1f %7u %7u\n",
+            offMicros / 1000.0,
+            (phase.busAtEnd.nanos100kHz - phase.busAtStart.nanos100kHz) / 1000000.0,
+            phase.busAtEnd.transactionCount - phase.busAtStart.transactionCount,
+            phase.busAtEnd.byteCount - phase.busAtStart.byteCount);
+    }
+}
+
+
+}
+}
+
@@ -0,0 +1,83 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+
+
+namespace Host {
+
+
+/// A timeline of the virtual time spent by the firmware.
+///
+/// The timeline is split into named phases. Every advance of the virtual
+/// clock by the firmware, by delays or by transactions on the I2C bus, is
+/// attributed to the activity of the innermost matching firmware function
+/// on the call stack. Time jumps of the simulation are not attributed and
+/// count as time with the power off.
+///
+namespace Timeline {
+
+
+/// The activities of the firmware.
+///
+enum class Activity : uint8_t {
+    KeyPad, ///< Time in `KeyPad::scanKeys()`.
+    ViewLoop, ///< Time in the `loop()` method of a view, without display updates.
+    Display, ///< Time in the `Display` functions.
+    Servo, ///< Time in `Hardware::dropFood()`.
+    Other, ///< All other time, like the loop delay or the start-up.
+};
+
+/// The number of activities.
+///
+const uint8_t cActivityCount = 5;
+
+
+/// Enable the timeline.
+///
+void setEnabled(bool enabled);
+
+/// Start a new phase.
+///
+/// This ends the current phase at the current virtual time.
+///
+/// @param name The name of the phase.
+///
+void beginPhase(const std::string &name);
+
+/// Record an advance of the virtual time.
+///
+/// @param micros The number of microseconds.
+///
+void record(uint64_t micros);
+
+/// Print all phases as table.
+///
+void print(FILE *file);
+
+
+}
+}
+
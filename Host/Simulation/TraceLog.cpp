@@ -0,0 +1,166 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "TraceLog.h"
+
+
+#include "VirtualTime.h"
+
+#include <string>
+#include <vector>
+
+
+namespace Host {
+namespace TraceLog {
+
+
+/// The thread of the events in the trace viewer.
+///
+enum class Track : uint8_t {
+    Firmware = 1, ///< The markers and power cycles.
+    I2cBus = 2, ///< The transactions on the bus.
+};
+
+
+/// One event of the trace.
+///
+struct Event {
+    std::string name; ///< The name of the event.
+    char phase; ///< `B` for begin, `E` for end and `X` for a complete event.
+    Track track; ///< The thread of the event.
+    uint64_t micros; ///< The virtual time of the event.
+    uint64_t durationMicros; ///< The duration of a complete event.
+    uint8_t byteCount; ///< The number of data bytes of a transaction.
+};
+
+
+/// Flag if the trace is enabled.
+///
+static bool gEnabled = false;
+
+/// All recorded events.
+///
+static std::vector<Event> gEvents;
+
+
+/// Add an event at the current virtual time.
+///
+static void addEvent(const std::string &name, char phase, Track track, uint64_t durationMicros, uint8_t byteCount)
+{
+    Event event;
+    event.name = name;
+    event.phase = phase;
+    event.track = track;
+    event.micros = VirtualTime::getMicros();
+    event.durationMicros = durationMicros;
+    event.byteCount = byteCount;
+    gEvents.push_back(event);
+}
+
+
+/// Get the name of a device on the bus.
+///
+static std::string getDeviceName(uint8_t address)
+{
+    switch (address) {
+    case 0x20: return "LCD";
+    case 0x68: return "RTC";
+    default: break;
+    }
+    char name[8];
+    snprintf(name, sizeof(name), "0x%02x", address);
+    return name;
+}
+
+
+/// Write a string as JSON string.
+///
+static void writeString(FILE *file, const std::string &text)
+{
+    fputc('"', file);
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+        }
+        fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+
+void setEnabled(bool enabled)
+{
+    gEnabled = enabled;
+}
+
+
+void begin(const char *name)
+{
+    if (gEnabled) {
+        addEvent(name, 'B', Track::Firmware, 0, 0);
+    }
+}
+
+
+void end(const char *name)
+{
+    if (gEnabled) {
+        addEvent(name, 'E', Track::Firmware, 0, 0);
+    }
+}
+
+
+void recordTransaction(const BusMonitor::Transaction &transaction, uint64_t durationMicros)
+{
+    if (gEnabled) {
+        std::string name = getDeviceName(transaction.address);
+        name += transaction.isRead ? " read" : " write";
+        if (!transaction.isAcknowledged) {
+            name += " NACK";
+        }
+        addEvent(name, 'X', Track::I2cBus, durationMicros, transaction.byteCount);
+    }
+}
+
+
+void write(FILE *file)
+{
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Firmware\"}},\n",
+        static_cast<unsigned>(Track::Firmware));
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"I2C Bus\"}}",
+        static_cast<unsigned>(Track::I2cBus));
+    for (const auto &event : gEvents) {
+        fprintf(file, ",\n{\"name\":");
+        writeString(file, event.name);
+        fprintf(file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%llu",
+            event.phase, static_cast<unsigned>(event.track), static_cast<unsigned long long>(event.micros));
+        if (event.phase == 'X') {
+            fprintf(file, ",\"dur\":%llu,\"args\":{\"bytes\":%u}",
+                static_cast<unsigned long long>(event.durationMicros), event.byteCount);
+        }
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n]}\n");
+}
+
+
+}
+}
+
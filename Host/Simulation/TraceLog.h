@@ -0,0 +1,72 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "BusMonitor.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+namespace Host {
+
+
+/// A trace of the firmware on the virtual clock.
+///
+/// The trace collects the markers of `CatFeeder/Trace.h`, the power cycles
+/// and the transactions on the I2C bus. It is written in the trace event
+/// format of Chrome, which can be opened with `chrome://tracing` or the
+/// Perfetto UI. The trace is kept in memory until it is written.
+///
+namespace TraceLog {
+
+
+/// Enable the trace.
+///
+void setEnabled(bool enabled);
+
+/// Record the begin of a traced block of the firmware.
+///
+/// @param name The name of the block.
+///
+void begin(const char *name);
+
+/// Record the end of a traced block of the firmware.
+///
+/// @param name The name of the block.
+///
+void end(const char *name);
+
+/// Record a transaction on the I2C bus.
+///
+/// @param transaction The transaction.
+/// @param durationMicros The bus time of the transaction.
+///
+void recordTransaction(const BusMonitor::Transaction &transaction, uint64_t durationMicros);
+
+/// Write the trace as JSON.
+///
+void write(FILE *file);
+
+
+}
+}
+
@@ -0,0 +1,132 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "VirtualTime.h"
+
+
+#include "Timeline.h"
+
+
+namespace Host {
+namespace VirtualTime {
+
+
+/// The number of microseconds per second.
+///
+static const uint64_t cMicrosPerSecond = 1000000;
+
+/// The current virtual time.
+///
+static uint64_t gMicros = 0;
+
+/// The RTC time base at time zero.
+///
+static uint32_t gRtcTimeBase = 0;
+
+/// The function to get the time of the next event.
+///
+static NextEventFunction gNextEvent = nullptr;
+
+/// The function called at the time of an event.
+///
+static EventFunction gHandleEvent = nullptr;
+
+/// If an event is handled at the moment.
+///
+static bool gIsHandlingEvent = false;
+
+
+void reset(uint32_t rtcTimeBase)
+{
+    gMicros = 0;
+    gRtcTimeBase = rtcTimeBase;
+}
+
+
+uint64_t getMicros()
+{
+    return gMicros;
+}
+
+
+void advance(uint64_t micros)
+{
+    Timeline::record(micros);
+    uint64_t endMicros = gMicros + micros;
+    // Time spent in an event handler does not deliver further events.
+    if (gNextEvent != nullptr && !gIsHandlingEvent) {
+        gIsHandlingEvent = true;
+        for (uint64_t eventMicros = gNextEvent(); eventMicros > gMicros && eventMicros <= endMicros;
+            eventMicros = gNextEvent()) {
+            gMicros = eventMicros;
+            gHandleEvent();
+            // The handler may spend time, which delays the rest.
+            endMicros += gMicros - eventMicros;
+        }
+        gIsHandlingEvent = false;
+    }
+    gMicros = endMicros;
+}
+
+
+void advanceTo(uint64_t micros)
+{
+    if (micros > gMicros) {
+        gMicros = micros;
+    }
+}
+
+
+void setEventSource(NextEventFunction nextEvent, EventFunction handleEvent)
+{
+    gNextEvent = nextEvent;
+    gHandleEvent = handleEvent;
+}
+
+
+uint32_t getRtcSeconds()
+{
+    return gRtcTimeBase + static_cast<uint32_t>(gMicros / cMicrosPerSecond);
+}
+
+
+uint32_t getRtcSubsecondMicros()
+{
+    return static_cast<uint32_t>(gMicros % cMicrosPerSecond);
+}
+
+
+uint64_t getNextRtcSecondMicros()
+{
+    return (gMicros / cMicrosPerSecond + 1) * cMicrosPerSecond;
+}
+
+
+uint64_t getMicrosAtRtcSeconds(uint32_t rtcSeconds)
+{
+    if (rtcSeconds < gRtcTimeBase) {
+        return 0;
+    }
+    return static_cast<uint64_t>(rtcSeconds - gRtcTimeBase) * cMicrosPerSecond;
+}
+
+
+}
+}
+
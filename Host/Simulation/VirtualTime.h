@@ -0,0 +1,113 @@
+#pragma once
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <stdint.h>
+
+
+namespace Host {
+
+
+/// The virtual clock of the simulation.
+///
+/// Nothing in the host build sleeps. `delay()` and `delayMicroseconds()`
+/// just move this clock forward, and `millis()`/`micros()` are derived
+/// from it. The same clock drives the time base of the simulated RTC
+/// crystal, which keeps running while the device is powered off.
+///
+namespace VirtualTime {
+
+
+/// The value of a `NextEventFunction` if no event is scheduled.
+///
+const uint64_t cNoEvent = UINT64_MAX;
+
+/// A function which returns the virtual time of the next event.
+///
+/// The returned time must be in the future, or `cNoEvent`.
+///
+typedef uint64_t (*NextEventFunction)();
+
+/// A function which is called at the virtual time of an event.
+///
+typedef void (*EventFunction)();
+
+
+/// Reset the virtual clock to zero.
+///
+/// @param rtcTimeBase The value of the RTC time base at time zero, in
+///    seconds since 2000-01-01 00:00:00.
+///
+void reset(uint32_t rtcTimeBase);
+
+/// Get the microseconds since the start of the simulation.
+///
+uint64_t getMicros();
+
+/// Move the clock forward.
+///
+/// This is used for the time spent by the firmware, which is recorded in
+/// the timeline. The clock stops at each event on the way and calls the
+/// event function, so interrupts reach the firmware at the right time.
+///
+/// @param micros The number of microseconds to advance.
+///
+void advance(uint64_t micros);
+
+/// Move the clock forward to the given time.
+///
+/// This is used for time jumps of the simulation. If the time is in the
+/// past, the clock is not changed. No events are delivered.
+///
+void advanceTo(uint64_t micros);
+
+/// Set the source of the events delivered by `advance()`.
+///
+/// @param nextEvent The function to get the time of the next event.
+/// @param handleEvent The function called at the time of the event.
+///
+void setEventSource(NextEventFunction nextEvent, EventFunction handleEvent);
+
+/// Get the RTC time base.
+///
+/// @return The seconds since 2000-01-01 00:00:00 of the RTC crystal.
+///
+uint32_t getRtcSeconds();
+
+/// Get the microseconds since the start of the current RTC second.
+///
+uint32_t getRtcSubsecondMicros();
+
+/// Get the virtual time of the next start of an RTC second.
+///
+uint64_t getNextRtcSecondMicros();
+
+/// Get the virtual time when the RTC time base reaches a value.
+///
+/// @param rtcSeconds The RTC time base in seconds since 2000-01-01 00:00:00.
+/// @return The virtual time in microseconds.
+///
+uint64_t getMicrosAtRtcSeconds(uint32_t rtcSeconds);
+
+
+}
+}
+
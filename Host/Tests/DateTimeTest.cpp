@@ -0,0 +1,402 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Tests for the `DateTime` class of the firmware.
+//
+// Usage: catfeeder_test_datetime
+//
+// The reference values were calculated independently of the firmware, with
+// a proleptic Gregorian calendar. The randomized tests compare the firmware
+// with a simple day count, which walks through the years and months. They
+// use a fixed seed, so every run checks the same values. The program prints
+// each failed check and exits with a non zero code if any check failed.
+
+
+#include "LRDateTime.h"
+
+#include <cstdio>
+#include <cstring>
+
+
+using lr::DateTime;
+
+
+/// A date/time with its expected values.
+///
+struct Reference {
+    uint32_t seconds; ///< The seconds since 2000-01-01 00:00:00.
+    uint16_t year; ///< The year.
+    uint8_t month; ///< The month.
+    uint8_t day; ///< The day.
+    uint8_t hour; ///< The hour.
+    uint8_t minute; ///< The minute.
+    uint8_t second; ///< The second.
+    uint8_t dayOfWeek; ///< The day of the week, 0=Sunday.
+};
+
+
+/// The reference values, at the boundaries of the supported range and
+/// around the leap days.
+///
+static const Reference cReferences[] = {
+    {0UL, 2000, 1, 1, 0, 0, 0, 6},
+    {5140800UL, 2000, 2, 29, 12, 0, 0, 2},
+    {5184000UL, 2000, 3, 1, 0, 0, 0, 3},
+    {31622399UL, 2000, 12, 31, 23, 59, 59, 0},
+    {31622400UL, 2001, 1, 1, 0, 0, 0, 1},
+    {2147483647UL, 2068, 1, 19, 3, 14, 7, 4},
+    {3155759999UL, 2099, 12, 31, 23, 59, 59, 4},
+    {3155760000UL, 2100, 1, 1, 0, 0, 0, 5},
+    {3160857599UL, 2100, 2, 28, 23, 59, 59, 0},
+    {3160857600UL, 2100, 3, 1, 0, 0, 0, 1},
+    {4294967295UL, 2136, 2, 7, 6, 28, 15, 2},
+};
+
+
+/// A format with its expected output.
+///
+struct FormatReference {
+    DateTime::Format format; ///< The format.
+    const char *text; ///< The expected text for 2099-01-02 03:04:05.
+};
+
+
+/// The expected output for each format, with leading zeros in all fields.
+///
+static const FormatReference cFormatReferences[] = {
+    {DateTime::Format::ISO, "2099-01-02T03:04:05"},
+    {DateTime::Format::Long, "2099-01-02 03:04:05"},
+    {DateTime::Format::ISODate, "2099-01-02"},
+    {DateTime::Format::ISOBasicDate, "20990102"},
+    {DateTime::Format::ISOTime, "03:04:05"},
+    {DateTime::Format::ISOBasicTime, "030405"},
+    {DateTime::Format::ShortDate, "02.01."},
+    {DateTime::Format::ShortTime, "03:04"},
+};
+
+
+/// The number of random values for each randomized test.
+///
+static const uint32_t cRandomCount = 200000;
+
+/// The number of seconds per day.
+///
+static const uint32_t cSecondsPerDay = 86400;
+
+
+/// The number of failed checks.
+///
+static uint32_t gFailureCount = 0;
+
+
+/// Check a value.
+///
+static void check(const char *name, int64_t actual, int64_t expected)
+{
+    if (actual != expected) {
+        fprintf(stderr, "FAILED %s: %lld, expected %lld\n", name,
+            static_cast<long long>(actual), static_cast<long long>(expected));
+        ++gFailureCount;
+    }
+}
+
+
+/// Check a text.
+///
+static void checkText(const char *name, const char *actual, const char *expected)
+{
+    if (strcmp(actual, expected) != 0) {
+        fprintf(stderr, "FAILED %s: \"%s\", expected \"%s\"\n", name, actual, expected);
+        ++gFailureCount;
+    }
+}
+
+
+/// Check all fields of a date/time.
+///
+static void checkFields(const char *name, const DateTime &dateTime, uint16_t year, uint8_t month, uint8_t day,
+    uint8_t hour, uint8_t minute, uint8_t second, uint8_t dayOfWeek)
+{
+    const uint32_t failureCount = gFailureCount;
+    check(name, dateTime.getYear(), year);
+    check(name, dateTime.getMonth(), month);
+    check(name, dateTime.getDay(), day);
+    check(name, dateTime.getHour(), hour);
+    check(name, dateTime.getMinute(), minute);
+    check(name, dateTime.getSecond(), second);
+    check(name, dateTime.getDayOfWeek(), dayOfWeek);
+    if (gFailureCount != failureCount) {
+        fprintf(stderr, "  for %04u-%02u-%02u %02u:%02u:%02u\n", year, month, day, hour, minute, second);
+    }
+}
+
+
+/// Check all fields of a date/time against a reference.
+///
+static void checkFields(const char *name, const DateTime &dateTime, const Reference &reference)
+{
+    checkFields(name, dateTime, reference.year, reference.month, reference.day,
+        reference.hour, reference.minute, reference.second, reference.dayOfWeek);
+}
+
+
+/// A simple and reproducible pseudo random number generator (xorshift32).
+///
+static uint32_t getRandom()
+{
+    static uint32_t state = 0x2017f00d;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+/// Check if a year is a leap year, the reference implementation.
+///
+static bool isLeapYear(uint16_t year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+
+/// Get the number of days of a month, the reference implementation.
+///
+static uint8_t getDaysInMonth(uint16_t year, uint8_t month)
+{
+    static const uint8_t daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && isLeapYear(year)) {
+        return 29;
+    }
+    return daysInMonth[month - 1];
+}
+
+
+/// Count the days since 2000-01-01, the reference implementation.
+///
+static uint32_t getReferenceDays(uint16_t year, uint8_t month, uint8_t day)
+{
+    uint32_t days = 0;
+    for (uint16_t y = 2000; y < year; ++y) {
+        days += isLeapYear(y) ? 366 : 365;
+    }
+    for (uint8_t m = 1; m < month; ++m) {
+        days += getDaysInMonth(year, m);
+    }
+    return days + day - 1;
+}
+
+
+/// Get the date/time for the seconds since 2000-01-01, the reference implementation.
+///
+static Reference getReference(uint32_t seconds)
+{
+    Reference reference;
+    reference.seconds = seconds;
+    uint32_t days = seconds / cSecondsPerDay;
+    const uint32_t secondOfDay = seconds % cSecondsPerDay;
+    reference.hour = static_cast<uint8_t>(secondOfDay / 3600);
+    reference.minute = static_cast<uint8_t>(secondOfDay / 60 % 60);
+    reference.second = static_cast<uint8_t>(secondOfDay % 60);
+    reference.dayOfWeek = static_cast<uint8_t>((days + 6) % 7); // 2000-01-01 was a Saturday.
+    reference.year = 2000;
+    while (days >= (isLeapYear(reference.year) ? 366U : 365U)) {
+        days -= isLeapYear(reference.year) ? 366 : 365;
+        ++reference.year;
+    }
+    reference.month = 1;
+    while (days >= getDaysInMonth(reference.year, reference.month)) {
+        days -= getDaysInMonth(reference.year, reference.month);
+        ++reference.month;
+    }
+    reference.day = static_cast<uint8_t>(days + 1);
+    return reference;
+}
+
+
+/// Test the conversion from and to seconds with the reference values.
+///
+static void testSecondsConversion()
+{
+    for (const Reference &reference : cReferences) {
+        const DateTime dateTime(reference.year, reference.month, reference.day,
+            reference.hour, reference.minute, reference.second);
+        checkFields("constructor", dateTime, reference);
+        check("toSecondsSince2000", dateTime.toSecondsSince2000(), reference.seconds);
+        checkFields("fromSecondsSince2000", DateTime::fromSecondsSince2000(reference.seconds), reference);
+    }
+    check("isFirst", DateTime::fromSecondsSince2000(0).isFirst(), true);
+    check("isFirst", DateTime::fromSecondsSince2000(1).isFirst(), false);
+}
+
+
+/// Test the last date/time which can be stored, after the 32bit seconds range.
+///
+static void testLastYear()
+{
+    const DateTime dateTime(2255, 12, 31, 23, 59, 59);
+    checkFields("constructor(2255)", dateTime, 2255, 12, 31, 23, 59, 59, 1);
+    check("operator<(2255)", DateTime(2136, 2, 7, 6, 28, 15) < dateTime, true);
+    check("operator<(2255)", DateTime(2255, 12, 31, 23, 59, 58) < dateTime, true);
+}
+
+
+/// Test adding days across month, year and century boundaries.
+///
+static void testAddDays()
+{
+    const DateTime endOf2099(2099, 12, 31, 12, 30, 45);
+    checkFields("addDays(1)", endOf2099.addDays(1), 2100, 1, 1, 12, 30, 45, 5);
+    checkFields("addDays(59)", endOf2099.addDays(59), 2100, 2, 28, 12, 30, 45, 0);
+    checkFields("addDays(60)", endOf2099.addDays(60), 2100, 3, 1, 12, 30, 45, 1);
+    checkFields("addDays(-36524)", endOf2099.addDays(-36524), 2000, 1, 1, 12, 30, 45, 6);
+    checkFields("addDays(-1)", DateTime(2000, 3, 1).addDays(-1), 2000, 2, 29, 0, 0, 0, 2);
+    checkFields("addDays(49710)", DateTime(2000, 1, 1).addDays(49710), 2136, 2, 7, 0, 0, 0, 2);
+    checkFields("addDays(-49710)", DateTime(2136, 2, 7, 6, 28, 15).addDays(-49710), 2000, 1, 1, 6, 28, 15, 6);
+}
+
+
+/// Test the difference between two date/times in both directions.
+///
+static void testSecondsTo()
+{
+    const DateTime first(2000, 1, 1);
+    const DateTime last(2068, 1, 19, 3, 14, 7);
+    check("secondsTo", first.secondsTo(first), 0);
+    check("secondsTo", first.secondsTo(last), 2147483647LL);
+    check("secondsTo", last.secondsTo(first), -2147483647LL);
+    check("secondsTo", DateTime(2099, 12, 31, 23, 59, 59).secondsTo(DateTime(2100, 1, 1)), 1);
+    check("secondsTo", DateTime(2100, 3, 1).secondsTo(DateTime(2100, 2, 28)), -86400);
+    check("secondsTo", DateTime(2100, 3, 1).secondsTo(DateTime(2136, 2, 7, 6, 28, 15)), 1134109695LL);
+}
+
+
+/// Test that the constructor constrains all values to valid ranges.
+///
+static void testClamping()
+{
+    checkFields("clamp(1999)", DateTime(1999, 0, 0, 24, 60, 60), 2000, 1, 1, 23, 59, 59, 6);
+    checkFields("clamp(2256)", DateTime(2256, 13, 32), 2255, 12, 31, 0, 0, 0, 1);
+    checkFields("clamp(65535)", DateTime(65535, 255, 255, 255, 255, 255), 2255, 12, 31, 23, 59, 59, 1);
+    checkFields("clamp(2000-02-30)", DateTime(2000, 2, 30), 2000, 2, 29, 0, 0, 0, 2);
+    checkFields("clamp(2100-02-29)", DateTime(2100, 2, 29), 2100, 2, 28, 0, 0, 0, 0);
+    checkFields("clamp(2099-04-31)", DateTime(2099, 4, 31), 2099, 4, 30, 0, 0, 0, 4);
+}
+
+
+/// Test the output of every format.
+///
+static void testFormats()
+{
+    const DateTime dateTime(2099, 1, 2, 3, 4, 5);
+    for (const FormatReference &reference : cFormatReferences) {
+        char buffer[DateTime::cMaximumFormatLength + 1];
+        checkText("toBuffer", dateTime.toBuffer(buffer, reference.format), reference.text);
+        checkText("toString", dateTime.toString(reference.format).c_str(), reference.text);
+    }
+    char buffer[DateTime::cMaximumFormatLength + 1];
+    checkText("toBuffer(first)", DateTime().toBuffer(buffer, DateTime::Format::Long), "2000-01-01 00:00:00");
+    checkText("toBuffer(2136)", DateTime::fromSecondsSince2000(4294967295UL).toBuffer(buffer, DateTime::Format::ISO),
+        "2136-02-07T06:28:15");
+    checkText("toBuffer(2255)", DateTime(2255, 12, 31, 23, 59, 59).toBuffer(buffer, DateTime::Format::Long),
+        "2255-12-31 23:59:59");
+    checkText("toBuffer(2255)", DateTime(2255, 12, 31, 23, 59, 59).toBuffer(buffer, DateTime::Format::ShortDate),
+        "31.12.");
+}
+
+
+/// Compare the conversions with the reference implementation for random seconds.
+///
+static void testRandomSeconds()
+{
+    for (uint32_t i = 0; i < cRandomCount; ++i) {
+        const uint32_t seconds = getRandom();
+        const Reference reference = getReference(seconds);
+        const DateTime dateTime = DateTime::fromSecondsSince2000(seconds);
+        checkFields("random fromSecondsSince2000", dateTime, reference);
+        check("random toSecondsSince2000", dateTime.toSecondsSince2000(), seconds);
+    }
+}
+
+
+/// Compare the constructor with the reference implementation for random dates,
+/// over all storable years.
+///
+static void testRandomDates()
+{
+    for (uint32_t i = 0; i < cRandomCount; ++i) {
+        const uint16_t year = static_cast<uint16_t>(2000 + getRandom() % 256);
+        const uint8_t month = static_cast<uint8_t>(1 + getRandom() % 12);
+        const uint8_t day = static_cast<uint8_t>(1 + getRandom() % getDaysInMonth(year, month));
+        const uint32_t days = getReferenceDays(year, month, day);
+        const DateTime dateTime(year, month, day, 12, 0, 0);
+        checkFields("random constructor", dateTime, year, month, day, 12, 0, 0, static_cast<uint8_t>((days + 6) % 7));
+        if (days < UINT32_MAX / cSecondsPerDay) {
+            check("random toSecondsSince2000", dateTime.toSecondsSince2000(), days * cSecondsPerDay + 43200);
+        }
+    }
+}
+
+
+/// Compare adding days and the difference with the reference implementation
+/// for random values.
+///
+static void testRandomArithmetic()
+{
+    // The last day which is complete in the 32bit range of seconds.
+    const uint32_t dayCount = UINT32_MAX / cSecondsPerDay;
+    for (uint32_t i = 0; i < cRandomCount; ++i) {
+        const uint32_t seconds = getRandom();
+        const uint32_t day = seconds / cSecondsPerDay;
+        const int32_t dayOffset = static_cast<int32_t>(getRandom() % dayCount) - static_cast<int32_t>(day);
+        const DateTime dateTime = DateTime::fromSecondsSince2000(seconds);
+        checkFields("random addDays", dateTime.addDays(dayOffset),
+            getReference(seconds + static_cast<uint32_t>(dayOffset) * cSecondsPerDay));
+        // Differences up to 34 years, which keep both values in range.
+        const int64_t offset = static_cast<int32_t>(getRandom()) / 2;
+        const int64_t otherSeconds = static_cast<int64_t>(seconds) + offset;
+        if (otherSeconds >= 0 && otherSeconds <= UINT32_MAX) {
+            check("random secondsTo", dateTime.secondsTo(DateTime::fromSecondsSince2000(static_cast<uint32_t>(otherSeconds))),
+                offset);
+        }
+    }
+}
+
+
+int main()
+{
+    testSecondsConversion();
+    testLastYear();
+    testAddDays();
+    testSecondsTo();
+    testClamping();
+    testFormats();
+    testRandomSeconds();
+    testRandomDates();
+    testRandomArithmetic();
+
+    if (gFailureCount > 0) {
+        fprintf(stderr, "%u checks failed.\n", gFailureCount);
+        return 1;
+    }
+    printf("All checks passed.\n");
+    return 0;
+}
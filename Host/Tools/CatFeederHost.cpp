@@ -0,0 +1,296 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Runs the unmodified firmware on the host.
+//
+// Usage: catfeeder_host [options]
+//
+// --programming       Start in programming mode.
+// --battery-low       Set the low battery signal.
+// --loops <count>     Number of loop() calls in programming mode (default 100).
+// --days <count>      Simulate the given number of days with regular wake-ups.
+// --interval <min>    The TPL5110 wake-up interval in minutes (default 60).
+// --alarm <hh:mm>     The alarm time set in the RTC (default 07:30).
+// --stale-alarm       Set the RTC alarm flag before the first power on.
+// --backup-low        Set the low backup battery flag of the RTC.
+// --rtc-reset         Start with an unconfigured RTC, like after a power-on reset.
+// --i2c-report        Print the I2C traffic per firmware function.
+// --i2c-log <file>    Write every I2C transaction into a CSV file.
+// --lcd-report        Print the I2C traffic to the LCD shield per firmware function.
+// --trace <file>      Write a Chrome trace of the firmware markers into a JSON file.
+//
+// Without `--days` a single power cycle is executed. All timing is virtual,
+// so delays in the firmware do not slow down the simulation. With `--days`,
+// the device is powered on by the TPL5110 timer and by the RTC alarm.
+
+
+#include "Board.h"
+#include "BusMonitor.h"
+#include "Firmware.h"
+#include "TraceLog.h"
+#include "VirtualTime.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+/// The RTC time base at the start of the simulation: 2017-01-01 00:00:00.
+///
+static const uint32_t cSimulationStart = 536544000;
+
+/// The number of microseconds per minute.
+///
+static const uint64_t cMicrosPerMinute = 60000000ull;
+
+/// The number of minutes per day.
+///
+static const uint64_t cMinutesPerDay = 1440;
+
+/// The default alarm time.
+///
+static const uint8_t cDefaultAlarmHour = 7;
+static const uint8_t cDefaultAlarmMinute = 30;
+
+
+/// Print the I2C totals.
+///
+static void printBusTotals(const char *title, const Host::BusMonitor::Totals &totals, uint64_t divisor)
+{
+    printf("%s: %.1f transactions, %.1f bytes, %.3f ms at 100kHz, %.3f ms at 400kHz\n",
+        title,
+        static_cast<double>(totals.transactionCount) / divisor,
+        static_cast<double>(totals.byteCount) / divisor,
+        totals.nanos100kHz / 1000000.0 / divisor,
+        totals.nanos400kHz / 1000000.0 / divisor);
+}
+
+
+/// Print the content of the LCD and the cost of the LCD updates.
+///
+static void printLcd()
+{
+    const Host::RgbLcdShield &shield = Host::Board::getLcdShield();
+    const Host::Hd44780 &lcd = shield.getLcd();
+    printf("LCD (backlight 0x%x):\n", shield.getBacklight());
+    lcd.print(stdout);
+    const Host::BusMonitor::Totals &totals = Host::BusMonitor::getCycleTotals(Host::RgbLcdShield::cAddress);
+    const uint32_t lcdWriteCount = lcd.getInstructionCount() + lcd.getDataWriteCount();
+    printf("LCD: %u instructions, %u data writes, %u I2C bytes, %.1f I2C bytes per LCD write\n",
+        lcd.getInstructionCount(), lcd.getDataWriteCount(), totals.byteCount,
+        (lcdWriteCount > 0) ? static_cast<double>(totals.byteCount) / lcdWriteCount : 0.0);
+    // The write rate only counts the bus time of the writes to the LCD pins.
+    const uint64_t lcdBusNanos = shield.getLcdBusNanos();
+    printf("LCD: %.3f ms bus time at 100kHz, %.0f LCD writes per second\n",
+        lcdBusNanos / 1000000.0, (lcdBusNanos > 0) ? lcdWriteCount * 1e9 / lcdBusNanos : 0.0);
+}
+
+
+/// Run a single power cycle and print the result.
+///
+static void runSinglePowerCycle(uint32_t loopCount)
+{
+    const auto result = Host::Firmware::run(loopCount);
+    if (result.isPoweredOff) {
+        printf("Power off after %.3f ms.\n", result.awakeMicros / 1000.0);
+    } else {
+        printf("Stopped after %u loops, %.3f ms since boot.\n", result.loopCount, result.awakeMicros / 1000.0);
+    }
+    printBusTotals("I2C per power cycle", Host::BusMonitor::getCycleTotals(), 1);
+    printLcd();
+}
+
+
+/// Simulate the timer and alarm wake-ups for a number of days.
+///
+static void runDays(uint32_t days, uint32_t intervalMinutes)
+{
+    Host::Board::setSerialOutput(nullptr);
+    Host::Pcf8523 &rtc = Host::Board::getRtc();
+    const auto hostStart = std::chrono::steady_clock::now();
+    const uint64_t endMicros = days * cMinutesPerDay * cMicrosPerMinute;
+    const uint64_t intervalMicros = intervalMinutes * cMicrosPerMinute;
+    uint64_t nextTimerMicros = 0;
+    uint64_t wakeCount = 0;
+    uint64_t alarmWakeCount = 0;
+    uint64_t totalAwakeMicros = 0;
+    uint64_t maximumAwakeMicros = 0;
+    uint64_t alarmAwakeMicros = 0;
+    uint64_t maximumRegularAwakeMicros = 0;
+    while (true) {
+        // The device is powered on by the TPL5110 or by the INT1 output of the RTC.
+        const uint64_t alarmMicros = rtc.getNextInterruptMicros();
+        const uint64_t wakeMicros = (alarmMicros < nextTimerMicros) ? alarmMicros : nextTimerMicros;
+        if (wakeMicros >= endMicros) {
+            break;
+        }
+        Host::VirtualTime::advanceTo(wakeMicros);
+        const bool isAlarmWake = (wakeMicros == alarmMicros);
+        while (nextTimerMicros <= wakeMicros) {
+            nextTimerMicros += intervalMicros;
+        }
+        const auto result = Host::Firmware::run(0);
+        ++wakeCount;
+        totalAwakeMicros += result.awakeMicros;
+        if (isAlarmWake) {
+            ++alarmWakeCount;
+            alarmAwakeMicros += result.awakeMicros;
+        } else if (result.awakeMicros > maximumRegularAwakeMicros) {
+            maximumRegularAwakeMicros = result.awakeMicros;
+        }
+        if (result.awakeMicros > maximumAwakeMicros) {
+            maximumAwakeMicros = result.awakeMicros;
+        }
+    }
+    const auto hostElapsed = std::chrono::steady_clock::now() - hostStart;
+    const double hostSeconds = std::chrono::duration<double>(hostElapsed).count();
+    printf("Simulated %u days with %llu wake-ups (%llu by the RTC alarm) in %.3f s host time.\n",
+        days, static_cast<unsigned long long>(wakeCount), static_cast<unsigned long long>(alarmWakeCount),
+        hostSeconds);
+    if (wakeCount == 0) {
+        return;
+    }
+    printf("Total awake time: %.3f s\n", totalAwakeMicros / 1000000.0);
+    printf("Awake time per day: %.3f ms\n", (totalAwakeMicros / 1000.0) / days);
+    printf("Awake time per wake-up: %.3f ms average, %.3f ms maximum\n",
+        (totalAwakeMicros / 1000.0) / wakeCount, maximumAwakeMicros / 1000.0);
+    if (alarmWakeCount > 0) {
+        printf("Awake time per feeding: %.3f ms average\n", (alarmAwakeMicros / 1000.0) / alarmWakeCount);
+    }
+    if (wakeCount > alarmWakeCount) {
+        // The timer wake-ups without alarm only measure the time from boot to the done signal.
+        printf("Boot to done signal per timer wake-up: %.3f ms average, %.3f ms maximum\n",
+            ((totalAwakeMicros - alarmAwakeMicros) / 1000.0) / (wakeCount - alarmWakeCount),
+            maximumRegularAwakeMicros / 1000.0);
+    }
+    printBusTotals("I2C per wake-up", Host::BusMonitor::getTotals(), wakeCount);
+    printBusTotals("I2C per day", Host::BusMonitor::getTotals(), days);
+}
+
+
+int main(int argc, char *argv[])
+{
+    bool isProgrammingMode = false;
+    bool isBatteryLow = false;
+    uint32_t loopCount = 100;
+    uint32_t days = 0;
+    uint32_t intervalMinutes = 60;
+    uint8_t alarmHour = cDefaultAlarmHour;
+    uint8_t alarmMinute = cDefaultAlarmMinute;
+    bool isStaleAlarm = false;
+    bool isBackupBatteryLow = false;
+    bool isRtcReset = false;
+    bool isBusReportEnabled = false;
+    bool isLcdReportEnabled = false;
+    FILE *traceFile = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--programming") == 0) {
+            isProgrammingMode = true;
+        } else if (strcmp(argv[i], "--battery-low") == 0) {
+            isBatteryLow = true;
+        } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            loopCount = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--days") == 0 && i + 1 < argc) {
+            days = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            intervalMinutes = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--alarm") == 0 && i + 1 < argc) {
+            unsigned hour;
+            unsigned minute;
+            if (sscanf(argv[++i], "%u:%u", &hour, &minute) != 2 || hour > 23 || minute > 59) {
+                fprintf(stderr, "Invalid alarm time: %s\n", argv[i]);
+                return 1;
+            }
+            alarmHour = static_cast<uint8_t>(hour);
+            alarmMinute = static_cast<uint8_t>(minute);
+        } else if (strcmp(argv[i], "--stale-alarm") == 0) {
+            isStaleAlarm = true;
+        } else if (strcmp(argv[i], "--backup-low") == 0) {
+            isBackupBatteryLow = true;
+        } else if (strcmp(argv[i], "--rtc-reset") == 0) {
+            isRtcReset = true;
+        } else if (strcmp(argv[i], "--i2c-report") == 0) {
+            isBusReportEnabled = true;
+        } else if (strcmp(argv[i], "--lcd-report") == 0) {
+            isLcdReportEnabled = true;
+        } else if (strcmp(argv[i], "--i2c-log") == 0 && i + 1 < argc) {
+            FILE *logFile = fopen(argv[++i], "w");
+            if (logFile == nullptr) {
+                perror(argv[i]);
+                return 1;
+            }
+            Host::BusMonitor::setLogFile(logFile);
+            Host::BusMonitor::setAttributionEnabled(true);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            traceFile = fopen(argv[++i], "w");
+            if (traceFile == nullptr) {
+                perror(argv[i]);
+                return 1;
+            }
+            Host::TraceLog::setEnabled(true);
+        } else {
+            fprintf(stderr, "Usage: %s [--programming] [--battery-low] [--loops <count>]"
+                " [--days <count>] [--interval <minutes>] [--alarm <hh:mm>] [--stale-alarm]"
+                " [--backup-low] [--rtc-reset] [--i2c-report] [--i2c-log <file>] [--lcd-report]"
+                " [--trace <file>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (intervalMinutes == 0) {
+        intervalMinutes = 1;
+    }
+
+    if (isBusReportEnabled || isLcdReportEnabled) {
+        Host::BusMonitor::setAttributionEnabled(true);
+    }
+    Host::VirtualTime::reset(cSimulationStart);
+    Host::Board::setProgrammingMode(isProgrammingMode);
+    Host::Board::setBatteryLow(isBatteryLow);
+    Host::Pcf8523 &rtc = Host::Board::getRtc();
+    if (isRtcReset) {
+        rtc.powerOnReset();
+        rtc.setTime(cSimulationStart);
+    } else {
+        rtc.configure(cSimulationStart, alarmHour, alarmMinute);
+    }
+    rtc.setAlarmFlag(isStaleAlarm);
+    rtc.setBackupBatteryLow(isBackupBatteryLow);
+    if (days > 0) {
+        runDays(days, intervalMinutes);
+    } else {
+        runSinglePowerCycle(isProgrammingMode ? loopCount : 0);
+    }
+    if (isBusReportEnabled) {
+        printf("\n");
+        Host::BusMonitor::printReport(stdout);
+    }
+    if (isLcdReportEnabled) {
+        printf("\n");
+        Host::BusMonitor::printReport(stdout, Host::RgbLcdShield::cAddress);
+    }
+    if (traceFile != nullptr) {
+        Host::TraceLog::write(traceFile);
+        fclose(traceFile);
+    }
+    return 0;
+}
+
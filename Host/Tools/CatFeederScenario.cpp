@@ -0,0 +1,430 @@
+//
+// Lucky Resistor's Cat Feeder Project
+// ---------------------------------------------------------------------------
+// (c)2017 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+// Replays a script against the unmodified firmware on the host.
+//
+// Usage: catfeeder_scenario [--serial] [--i2c-report] [--trace <file>] <script>
+//
+// --serial            Print the serial output of the firmware.
+// --i2c-report        Print the I2C traffic per firmware function.
+// --trace <file>      Write a Chrome trace of the firmware markers into a JSON file.
+//
+// The script has one command per line, `#` starts a comment:
+//
+// phase <name>                  Start a new phase of the timeline.
+// programming <on|off>          Set the programming mode switch.
+// battery-low <on|off>          Set the low battery signal.
+// backup-low <on|off>           Set the low backup battery flag of the RTC.
+// time <yyyy-mm-dd> <hh:mm:ss>  Set the time of the RTC.
+// alarm <hh:mm>                 Set the alarm time of the RTC.
+// alarm-flag                    Fire the RTC alarm now, by setting the AF flag.
+// power-on                      Power on the device and run setup().
+// power-off                     Cut the power.
+// loop <count>                  Call loop() a number of times.
+// wait <ms>                     Run loop() for the given time, or let the
+//                               time pass if the power is off.
+// press <key> [<ms>]            Press plus, minus, select or exit for the
+//                               given time (default 100ms), release it and
+//                               run loop() for another 100ms.
+// wake                          Let the time pass until the next RTC alarm
+//                               and power on the device.
+// screen                        Print the content of the LCD.
+// expect <row> <text>           Stop with an error if the LCD row does not
+//                               contain the text.
+// bus-fault <address> <fault>   Let the I2C device with the address fail:
+//                               hold-clock holds SCL low after its address,
+//                               nack does not acknowledge it, none repairs it.
+// expect-aborts <count>         Stop with an error if the firmware did not
+//                               abort this number of I2C transactions to a
+//                               device which holds the clock, since the start.
+//
+// At the end, the time of each phase is printed, split into the activities
+// of the firmware and the time on the I2C bus.
+
+
+#include "Board.h"
+#include "BusMonitor.h"
+#include "Firmware.h"
+#include "I2cBus.h"
+#include "Timeline.h"
+#include "TraceLog.h"
+#include "VirtualTime.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+
+/// The RTC time base at the start of the simulation: 2017-01-01 00:00:00.
+///
+static const uint32_t cSimulationStart = 536544000;
+
+/// The default alarm time.
+///
+static const uint8_t cDefaultAlarmHour = 7;
+static const uint8_t cDefaultAlarmMinute = 30;
+
+/// The default time a key is pressed.
+///
+static const uint32_t cDefaultPressMillis = 100;
+
+/// The time after a key is released.
+///
+static const uint32_t cReleaseMillis = 100;
+
+/// The maximum length of a script line.
+///
+static const size_t cMaximumLineLength = 256;
+
+
+/// A key of the keypad with the button mask of the LCD shield.
+///
+struct KeyDefinition {
+    const char *name; ///< The name in the script.
+    uint8_t buttons; ///< The mask, like `KeyPad::Key`.
+};
+
+/// All keys of the keypad.
+///
+static const KeyDefinition cKeys[] = {
+    {"plus", 0x10},
+    {"minus", 0x08},
+    {"select", 0x04},
+    {"exit", 0x02},
+};
+
+
+/// The current script line, for error messages.
+///
+static unsigned gLineNumber = 0;
+
+
+/// Print the virtual time as prefix for a log line.
+///
+static void printTime()
+{
+    printf("[%10.3f ms] ", Host::VirtualTime::getMicros() / 1000.0);
+}
+
+
+/// Stop with an error in the current line.
+///
+static void fail(const char *message, const char *detail = "")
+{
+    fprintf(stderr, "Line %u: %s%s\n", gLineNumber, message, detail);
+    exit(1);
+}
+
+
+/// Parse an on/off value.
+///
+static bool parseSwitch(const char *value)
+{
+    if (strcmp(value, "on") == 0) {
+        return true;
+    } else if (strcmp(value, "off") == 0) {
+        return false;
+    }
+    fail("Expected on or off: ", value);
+    return false;
+}
+
+
+/// Unload the firmware if it sent the done signal.
+///
+static void handlePowerOff()
+{
+    if (!Host::Firmware::isRunning()) {
+        const auto result = Host::Firmware::powerOff();
+        if (result.isPoweredOff) {
+            printTime();
+            printf("Power off after %.3f ms awake.\n", result.awakeMicros / 1000.0);
+        }
+    }
+}
+
+
+/// Run loop() until the virtual time reached the given time.
+///
+static void runUntil(uint64_t micros)
+{
+    if (!Host::Firmware::isRunning()) {
+        Host::VirtualTime::advanceTo(micros);
+        return;
+    }
+    while (Host::VirtualTime::getMicros() < micros && Host::Firmware::loop()) {
+    }
+    handlePowerOff();
+}
+
+
+/// Power on the device.
+///
+static void powerOn()
+{
+    printTime();
+    printf("Power on.\n");
+    Host::Firmware::powerOn();
+    handlePowerOff();
+}
+
+
+/// Press a key for the given time.
+///
+static void pressKey(const char *name, uint32_t millis)
+{
+    uint8_t buttons = 0;
+    for (const auto &key : cKeys) {
+        if (strcmp(key.name, name) == 0) {
+            buttons = key.buttons;
+        }
+    }
+    if (buttons == 0) {
+        fail("Unknown key: ", name);
+    }
+    if (!Host::Firmware::isRunning()) {
+        fail("The device is not running.");
+    }
+    Host::RgbLcdShield &shield = Host::Board::getLcdShield();
+    const uint64_t pressMicros = Host::VirtualTime::getMicros();
+    shield.watchLcdWrite();
+    shield.setPressedButtons(buttons);
+    runUntil(pressMicros + millis * 1000ull);
+    shield.setPressedButtons(0);
+    runUntil(Host::VirtualTime::getMicros() + cReleaseMillis * 1000ull);
+    uint64_t lcdMicros;
+    printTime();
+    if (shield.getLcdWriteMicros(lcdMicros)) {
+        printf("Pressed %s, LCD response after %.3f ms.\n", name, (lcdMicros - pressMicros) / 1000.0);
+    } else {
+        printf("Pressed %s, no LCD response.\n", name);
+    }
+}
+
+
+/// A fault of an I2C device with its name in the script.
+///
+struct FaultDefinition {
+    const char *name; ///< The name in the script.
+    Host::I2cBus::Fault fault; ///< The fault.
+};
+
+/// All faults of I2C devices.
+///
+static const FaultDefinition cFaults[] = {
+    {"none", Host::I2cBus::Fault::None},
+    {"hold-clock", Host::I2cBus::Fault::HoldClock},
+    {"nack", Host::I2cBus::Fault::Nack},
+};
+
+
+/// Set the fault of an I2C device.
+///
+static void setBusFault(const char *address, const char *name)
+{
+    char *end = nullptr;
+    const unsigned long value = strtoul(address, &end, 0);
+    if (end == address || *end != '\0' || value > 0x7f) {
+        fail("Invalid I2C address: ", address);
+    }
+    for (const auto &fault : cFaults) {
+        if (strcmp(fault.name, name) == 0) {
+            Host::I2cBus::setFault(static_cast<uint8_t>(value), fault.fault);
+            return;
+        }
+    }
+    fail("Unknown fault: ", name);
+}
+
+
+/// Check the number of aborted I2C transactions.
+///
+static void expectAborts(uint32_t count)
+{
+    const uint32_t abortCount = Host::I2cBus::getAbortCount();
+    printTime();
+    printf("%u aborted I2C transactions.\n", abortCount);
+    if (abortCount != count) {
+        fail("Unexpected number of aborted I2C transactions.");
+    }
+}
+
+
+/// Check the text in a row of the LCD.
+///
+static void expectText(uint8_t row, const char *text)
+{
+    const Host::Hd44780 &lcd = Host::Board::getLcdShield().getLcd();
+    char rowText[Host::Hd44780::cColumnCount + 1];
+    for (uint8_t column = 0; column < Host::Hd44780::cColumnCount; ++column) {
+        rowText[column] = static_cast<char>(lcd.getCharacter(row, column));
+    }
+    rowText[Host::Hd44780::cColumnCount] = '\0';
+    if (strstr(rowText, text) == nullptr) {
+        lcd.print(stderr);
+        fail("Missing text on the LCD: ", text);
+    }
+}
+
+
+/// Execute one command of the script.
+///
+static void execute(char *line)
+{
+    const char *command = strtok(line, " \t\r\n");
+    if (command == nullptr || command[0] == '#') {
+        return;
+    }
+    const char *argument = strtok(nullptr, " \t\r\n");
+    const char *argument2 = strtok(nullptr, "\r\n");
+    Host::Pcf8523 &rtc = Host::Board::getRtc();
+    if (strcmp(command, "phase") == 0 && argument != nullptr) {
+        Host::Timeline::beginPhase(argument);
+    } else if (strcmp(command, "programming") == 0 && argument != nullptr) {
+        Host::Board::setProgrammingMode(parseSwitch(argument));
+    } else if (strcmp(command, "battery-low") == 0 && argument != nullptr) {
+        Host::Board::setBatteryLow(parseSwitch(argument));
+    } else if (strcmp(command, "backup-low") == 0 && argument != nullptr) {
+        rtc.setBackupBatteryLow(parseSwitch(argument));
+    } else if (strcmp(command, "time") == 0 && argument != nullptr && argument2 != nullptr) {
+        unsigned year, month, day, hour, minute, second;
+        if (sscanf(argument, "%u-%u-%u", &year, &month, &day) != 3
+            || sscanf(argument2, "%u:%u:%u", &hour, &minute, &second) != 3) {
+            fail("Invalid time.");
+        }
+        rtc.setTime(Host::Pcf8523::getSecondsSince2000(year, month, day, hour, minute, second));
+    } else if (strcmp(command, "alarm") == 0 && argument != nullptr) {
+        unsigned hour, minute;
+        if (sscanf(argument, "%u:%u", &hour, &minute) != 2 || hour > 23 || minute > 59) {
+            fail("Invalid alarm time: ", argument);
+        }
+        rtc.setAlarm(static_cast<uint8_t>(hour), static_cast<uint8_t>(minute));
+    } else if (strcmp(command, "alarm-flag") == 0) {
+        rtc.setAlarmFlag(true);
+    } else if (strcmp(command, "power-on") == 0) {
+        powerOn();
+    } else if (strcmp(command, "power-off") == 0) {
+        const auto result = Host::Firmware::powerOff();
+        printTime();
+        printf("Power cut after %.3f ms awake.\n", result.awakeMicros / 1000.0);
+    } else if (strcmp(command, "loop") == 0 && argument != nullptr) {
+        const unsigned long count = strtoul(argument, nullptr, 10);
+        for (unsigned long i = 0; i < count && Host::Firmware::loop(); ++i) {
+        }
+        handlePowerOff();
+    } else if (strcmp(command, "wait") == 0 && argument != nullptr) {
+        runUntil(Host::VirtualTime::getMicros() + strtoull(argument, nullptr, 10) * 1000ull);
+    } else if (strcmp(command, "press") == 0 && argument != nullptr) {
+        pressKey(argument, (argument2 != nullptr) ? strtoul(argument2, nullptr, 10) : cDefaultPressMillis);
+    } else if (strcmp(command, "wake") == 0) {
+        if (Host::Firmware::isRunning()) {
+            fail("The device is already running.");
+        }
+        const uint64_t alarmMicros = rtc.getNextInterruptMicros();
+        if (alarmMicros == Host::Pcf8523::cNoInterrupt) {
+            fail("No RTC alarm is scheduled.");
+        }
+        Host::VirtualTime::advanceTo(alarmMicros);
+        powerOn();
+    } else if (strcmp(command, "screen") == 0) {
+        printTime();
+        printf("LCD:\n");
+        Host::Board::getLcdShield().getLcd().print(stdout);
+    } else if (strcmp(command, "expect") == 0 && argument != nullptr && argument2 != nullptr) {
+        expectText(static_cast<uint8_t>(strtoul(argument, nullptr, 10)), argument2);
+    } else if (strcmp(command, "bus-fault") == 0 && argument != nullptr && argument2 != nullptr) {
+        setBusFault(argument, argument2);
+    } else if (strcmp(command, "expect-aborts") == 0 && argument != nullptr) {
+        expectAborts(static_cast<uint32_t>(strtoul(argument, nullptr, 10)));
+    } else {
+        fail("Invalid command: ", command);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *scriptPath = nullptr;
+    bool isSerialEnabled = false;
+    bool isBusReportEnabled = false;
+    const char *tracePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--serial") == 0) {
+            isSerialEnabled = true;
+        } else if (strcmp(argv[i], "--i2c-report") == 0) {
+            isBusReportEnabled = true;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (argv[i][0] != '-' && scriptPath == nullptr) {
+            scriptPath = argv[i];
+        } else {
+            scriptPath = nullptr;
+            break;
+        }
+    }
+    if (scriptPath == nullptr) {
+        fprintf(stderr, "Usage: %s [--serial] [--i2c-report] [--trace <file>] <script>\n", argv[0]);
+        return 1;
+    }
+    FILE *script = fopen(scriptPath, "r");
+    if (script == nullptr) {
+        perror(scriptPath);
+        return 1;
+    }
+    FILE *traceFile = nullptr;
+    if (tracePath != nullptr) {
+        traceFile = fopen(tracePath, "w");
+        if (traceFile == nullptr) {
+            perror(tracePath);
+            return 1;
+        }
+    }
+
+    Host::VirtualTime::reset(cSimulationStart);
+    Host::Board::getRtc().configure(cSimulationStart, cDefaultAlarmHour, cDefaultAlarmMinute);
+    Host::Board::setSerialOutput(isSerialEnabled ? stdout : nullptr);
+    Host::BusMonitor::setAttributionEnabled(isBusReportEnabled);
+    Host::Timeline::setEnabled(true);
+    Host::TraceLog::setEnabled(traceFile != nullptr);
+    char line[cMaximumLineLength];
+    while (fgets(line, sizeof(line), script) != nullptr) {
+        ++gLineNumber;
+        execute(line);
+    }
+    fclose(script);
+    if (Host::Firmware::isRunning()) {
+        Host::Firmware::powerOff();
+    }
+
+    printf("\n");
+    Host::Timeline::print(stdout);
+    if (isBusReportEnabled) {
+        printf("\n");
+        Host::BusMonitor::printReport(stdout);
+    }
+    if (traceFile != nullptr) {
+        Host::TraceLog::write(traceFile);
+        fclose(traceFile);
+    }
+    return 0;
+}
+